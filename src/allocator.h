@@ -35,6 +35,11 @@ namespace astl
 			return true;
         }
 
+        bool tryExpand(T* ptr, size_t, size_t new_n)
+        {
+            return ptr == reinterpret_cast<T*>(&data_[0]) && new_n <= N;
+        }
+
         FixedSizeAllocator() {};
 
     };
@@ -63,16 +68,48 @@ public:
     {
         if (n != 0)
         {
-            delete ptr;               
+            delete[] reinterpret_cast<uint8_t*>(ptr);
         }
 
         return true;
     }
 
+    bool tryExpand(T*, size_t, size_t)
+    {//new[] blocks can not grow
+        return false;
+    }
+
     HeapAllocator() {};
 };
 
 
+namespace aux
+{
+template<class Allocator, class T>
+auto tryExpand(Allocator& allocator, T* ptr, size_t old_n, size_t new_n, int) -> decltype(allocator.tryExpand(ptr, old_n, new_n))
+{
+    return allocator.tryExpand(ptr, old_n, new_n);
+}
+
+template<class Allocator, class T>
+bool tryExpand(Allocator& allocator, T* ptr, size_t old_n, size_t new_n, long)
+{//allocator has no in-place expansion hook
+    return false;
+}
+}
+
+//grows the block at ptr from old_n to new_n elements without moving it, if the allocator supports it
+template<class Allocator, class T>
+bool expandInPlace(Allocator& allocator, T* ptr, size_t old_n, size_t new_n)
+{
+    if (ptr == nullptr)
+    {
+        return false;
+    }
+    return aux::tryExpand(allocator, ptr, old_n, new_n, 0);
+}
+
+
 typedef size_t(*AllocationPolicyFunc)(size_t);
 
 inline size_t allocationPolicy2(size_t n)
@@ -1,57 +1,309 @@
 #ifndef ASTL_ARENA_H
 #define ASTL_ARENA_H
 
-#include "bitvector.h"
+#include "memory_operations.h"
 
 namespace astl
 {
+	namespace aux
+	{
+		template<class T>
+		union ArenaSlot
+		{
+			size_t next_free;
+			alignas(T) uint8_t storage[sizeof(T)];
+		};
+
+		//arenas without an is_monotonic member are taken to free their objects one by one
+		template<class Arena>
+		constexpr auto isMonotonic(int) -> decltype(Arena::is_monotonic)
+		{
+			return Arena::is_monotonic;
+		}
+
+		template<class Arena>
+		constexpr bool isMonotonic(long)
+		{
+			return false;
+		}
+
+		//merge sort of an intrusive singly linked list by node address, next(node) is the node's link field
+		template<class Node, class Next>
+		Node* sortByAddress(Node* head, Next next)
+		{
+			if (head == nullptr || next(head) == nullptr)
+			{
+				return head;
+			}
+			Node* slow = head;
+			for (Node* fast = next(head); fast != nullptr && next(fast) != nullptr; fast = next(next(fast)))
+			{
+				slow = next(slow);
+			}
+			Node* a = next(slow);
+			next(slow) = nullptr;
+			a = sortByAddress(a, next);
+			Node* b = sortByAddress(head, next);
+
+			Node* merged = nullptr;
+			Node** tail = &merged;
+			while (a != nullptr && b != nullptr)
+			{
+				Node*& lower = a < b ? a : b;
+				*tail = lower;
+				tail = &next(lower);
+				lower = next(lower);
+			}
+			*tail = a != nullptr ? a : b;
+			return merged;
+		}
+	}
+
+
+	//free slots form a singly linked list threaded through their own storage, slots past next_unused_ were never handed out
 	template<class T, size_t N>
 	class StaticArena
 	{
-		uint8_t data_[N * sizeof(T)];
-		StaticBitVector<size_t, N> available_slots_;
+		static const size_t NO_SLOT = ~static_cast<size_t>(0);
+
+		aux::ArenaSlot<T> data_[N];
+		size_t free_head_;
+		size_t next_unused_;
 
 	public:
 		static const bool is_movable = false;
+		static const bool is_monotonic = false;
 
 		StaticArena()
-			:available_slots_(N, 1) {};
+			:free_head_(NO_SLOT), next_unused_(0) {};
 
 		template <class ...Args>
 		T* create(Args&&... args)
 		{
-			for (size_t i = 0; i < available_slots_.size(); i++)
+			size_t i;
+			if (free_head_ != NO_SLOT)
 			{
-				if (available_slots_[i])
-				{
-					available_slots_[i] = false;
-					return new (data_ + i * sizeof(T)) T(std::forward<Args>(args)...);
-				}
+				i = free_head_;
+				free_head_ = data_[i].next_free;
+			}
+			else if (next_unused_ < N)
+			{
+				i = next_unused_++;
+			}
+			else
+			{
+				return nullptr;
 			}
-			return nullptr;
+			return new (data_[i].storage) T(std::forward<Args>(args)...);
 		}
 
+		//ptr must be live, slots never handed out and the most recently freed one are refused, any other slot destroyed
+		//twice would be handed out twice
 		bool destroy(T* ptr)
 		{
 			uint8_t* byte_ptr = reinterpret_cast<uint8_t*>(ptr);
+			uint8_t* begin = reinterpret_cast<uint8_t*>(&data_[0]);
 
-			if (byte_ptr < &data_[0] || byte_ptr > &data_[N * sizeof(T) - 1] || (byte_ptr - &data_[0]) % sizeof(T) != 0)
+			if (byte_ptr < begin || byte_ptr >= begin + sizeof(data_) || (byte_ptr - begin) % sizeof(aux::ArenaSlot<T>) != 0)
 			{
 				return false;
 			}
 
+			size_t i = (byte_ptr - begin) / sizeof(aux::ArenaSlot<T>);
+			if (i >= next_unused_ || i == free_head_)
+			{
+				return false;
+			}
 			ptr->~T();
-			available_slots_[(byte_ptr - &data_[0]) / sizeof(T)] = true;
+			data_[i].next_free = free_head_;
+			free_head_ = i;
 			return true;
 		}
 	};
 
 
+	//nodes are carved from heap slabs of BlockSize slots and recycled through an intrusive free list
+	template<class T, size_t BlockSize = 16>
+	class PoolArena
+	{
+		union Slot
+		{
+			Slot* next_free;
+			alignas(T) uint8_t storage[sizeof(T)];
+		};
+
+		struct Slab
+		{
+			Slab* next;
+			Slot slots[BlockSize];
+		};
+
+		Slab* slabs_;
+		Slot* free_head_;
+		size_t next_unused_;//first never used slot of the newest slab
+
+		bool addSlab()
+		{
+			Slab* slab = new Slab;
+			if (slab == nullptr)
+			{
+				return false;
+			}
+			slab->next = slabs_;
+			slabs_ = slab;
+			next_unused_ = 0;
+			return true;
+		}
+
+		void releaseAll()
+		{
+			while (slabs_ != nullptr)
+			{
+				Slab* next = slabs_->next;
+				delete slabs_;
+				slabs_ = next;
+			}
+			free_head_ = nullptr;
+			next_unused_ = BlockSize;
+		}
+
+	public:
+		static const bool is_movable = true;
+		static const bool is_monotonic = false;
+
+		PoolArena()
+			:slabs_(nullptr), free_head_(nullptr), next_unused_(BlockSize) {};
+
+		PoolArena(PoolArena&& x)
+			:slabs_(x.slabs_), free_head_(x.free_head_), next_unused_(x.next_unused_)
+		{
+			x.slabs_ = nullptr;
+			x.free_head_ = nullptr;
+			x.next_unused_ = BlockSize;
+		}
+
+		PoolArena& operator=(PoolArena&& x)
+		{
+			if (this != &x)
+			{
+				releaseAll();
+				slabs_ = x.slabs_;
+				free_head_ = x.free_head_;
+				next_unused_ = x.next_unused_;
+				x.slabs_ = nullptr;
+				x.free_head_ = nullptr;
+				x.next_unused_ = BlockSize;
+			}
+			return *this;
+		}
+
+		PoolArena(const PoolArena&) = delete;
+		PoolArena& operator=(const PoolArena&) = delete;
+
+		~PoolArena()
+		{
+			releaseAll();
+		}
+
+		template <class ...Args>
+		T* create(Args&&... args)
+		{
+			Slot* slot;
+			if (free_head_ != nullptr)
+			{
+				slot = free_head_;
+				free_head_ = slot->next_free;
+			}
+			else
+			{
+				if (next_unused_ == BlockSize && !addSlab())
+				{
+					return nullptr;
+				}
+				slot = &slabs_->slots[next_unused_++];
+			}
+			return new (slot->storage) T(std::forward<Args>(args)...);
+		}
+
+		bool destroy(T* ptr)
+		{
+			if (ptr == nullptr)
+			{
+				return false;
+			}
+			ptr->~T();
+			Slot* slot = reinterpret_cast<Slot*>(ptr);
+			slot->next_free = free_head_;
+			free_head_ = slot;
+			return true;
+		}
+
+		//returns slabs without live nodes to the heap. Slabs and free slots are both sorted by address, so the free slots of
+		//each slab form one run that is counted and unlinked in a single walk, the free list is left in address order
+		size_t releaseEmptySlabs()
+		{
+			Slab* newest = slabs_;
+			slabs_ = aux::sortByAddress(slabs_, [](Slab* slab) -> Slab*& {return slab->next;});
+			free_head_ = aux::sortByAddress(free_head_, [](Slot* slot) -> Slot*& {return slot->next_free;});
+
+			size_t n_released = 0;
+			Slab** link = &slabs_;
+			Slot** free_link = &free_head_;
+			while (*link != nullptr)
+			{
+				Slab* slab = *link;
+				while (*free_link != nullptr && *free_link < &slab->slots[0])
+				{
+					free_link = &(*free_link)->next_free;
+				}
+				size_t n_free = (slab == newest) ? BlockSize - next_unused_ : 0;
+				Slot* run_end = *free_link;
+				while (run_end != nullptr && run_end < &slab->slots[BlockSize])
+				{
+					n_free++;
+					run_end = run_end->next_free;
+				}
+
+				if (n_free != BlockSize)
+				{
+					link = &slab->next;
+					continue;
+				}
+
+				*free_link = run_end;
+				if (slab == newest)
+				{
+					newest = nullptr;
+					next_unused_ = BlockSize;
+				}
+				*link = slab->next;
+				delete slab;
+				n_released++;
+			}
+
+			//create() carves never used slots from the front slab
+			if (newest != nullptr && newest != slabs_)
+			{
+				link = &slabs_;
+				while (*link != newest)
+				{
+					link = &(*link)->next;
+				}
+				*link = newest->next;
+				newest->next = slabs_;
+				slabs_ = newest;
+			}
+			return n_released;
+		}
+	};
+
+
 	template<class T>
 	class HeapArena
 	{
 	public:
 		static const bool is_movable = true;
+		static const bool is_monotonic = false;
 
 		HeapArena() {};
 
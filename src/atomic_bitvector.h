@@ -0,0 +1,231 @@
+#ifndef ASTL_ATOMIC_BITVECTOR_H
+#define ASTL_ATOMIC_BITVECTOR_H
+
+#include "bit_operations.h"
+
+#if defined(ARDUINO)
+#include <util/atomic.h>
+#else
+#include <atomic>
+#endif
+
+namespace astl
+{
+
+namespace aux
+{
+
+#if defined(ARDUINO)
+//single byte loads and stores are atomic on AVR, read-modify-writes only mask interrupts for their few cycles
+typedef uint8_t atomic_word_type;
+
+class AtomicWord
+{
+    volatile atomic_word_type value_;
+public:
+    atomic_word_type load() const {return value_;};
+    void store(atomic_word_type value) {value_ = value;};
+
+    atomic_word_type fetchOr(atomic_word_type mask)
+    {
+        atomic_word_type old;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            old = value_;
+            value_ = old | mask;
+        }
+        return old;
+    }
+
+    atomic_word_type fetchAnd(atomic_word_type mask)
+    {
+        atomic_word_type old;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            old = value_;
+            value_ = old & mask;
+        }
+        return old;
+    }
+
+    //on failure expected receives the current value
+    bool compareExchange(atomic_word_type& expected, atomic_word_type desired)
+    {
+        bool exchanged;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            atomic_word_type current = value_;
+            exchanged = current == expected;
+            if (exchanged)
+            {
+                value_ = desired;
+            }
+            expected = current;
+        }
+        return exchanged;
+    }
+
+    AtomicWord()
+        :value_(0) {};
+};
+#else
+typedef size_t atomic_word_type;
+
+class AtomicWord
+{
+    std::atomic<atomic_word_type> value_;
+public:
+    atomic_word_type load() const {return value_.load(std::memory_order_acquire);};
+    void store(atomic_word_type value) {value_.store(value, std::memory_order_release);};
+    atomic_word_type fetchOr(atomic_word_type mask) {return value_.fetch_or(mask, std::memory_order_acq_rel);};
+    atomic_word_type fetchAnd(atomic_word_type mask) {return value_.fetch_and(mask, std::memory_order_acq_rel);};
+
+    //on failure expected receives the current value
+    bool compareExchange(atomic_word_type& expected, atomic_word_type desired)
+    {
+        return value_.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+
+    AtomicWord()
+        :value_(0) {};
+};
+#endif
+
+}
+
+
+//fixed size bit set whose single bit and whole word updates are atomic against other threads and ISRs,
+//meant as a lock free free-slot map: acquireFirstClear() claims a slot, testAndClear() gives it back
+template<size_t N>
+class AtomicBitVector
+{
+public:
+    typedef aux::atomic_word_type word_type;
+    static const size_t BITS_IN_WORD = sizeof(word_type) * 8;
+    static const size_t N_WORDS = (N + BITS_IN_WORD - 1) / BITS_IN_WORD;
+
+private:
+    static_assert(N != 0, "AtomicBitVector needs at least one bit");
+
+    //the bits past N in the last word are kept set so that the scans never hand them out
+    static const size_t PADDING_BITS = N_WORDS * BITS_IN_WORD - N;
+
+    aux::AtomicWord words_[N_WORDS];
+
+    static word_type bitMask(size_t pos) {return static_cast<word_type>(static_cast<word_type>(1) << (pos % BITS_IN_WORD));};
+
+    static word_type paddingMask()
+    {
+        return PADDING_BITS == 0 ? 0 : static_cast<word_type>(~aux::lowBitsMask<word_type>(BITS_IN_WORD - PADDING_BITS));
+    }
+
+    static word_type withoutPadding(size_t i, word_type value)
+    {
+        return i == N_WORDS - 1 ? static_cast<word_type>(value & ~paddingMask()) : value;
+    }
+
+    //claims the lowest clear bit of word i, retrying while other writers change the word
+    size_t claimInWord(size_t i)
+    {
+        word_type word = words_[i].load();
+        while (word != static_cast<word_type>(~static_cast<word_type>(0)))
+        {
+            word_type bit = static_cast<word_type>(~word & (word + 1));
+            if (words_[i].compareExchange(word, static_cast<word_type>(word | bit)))
+            {
+                return i * BITS_IN_WORD + aux::countTrailingZeros(bit);
+            }
+        }
+        return N;
+    }
+
+public:
+    constexpr size_t size() const {return N;};
+
+    bool test(size_t pos) const
+    {
+        return (words_[pos / BITS_IN_WORD].load() & bitMask(pos)) != 0;
+    }
+
+    bool operator[](size_t pos) const {return test(pos);};
+
+    //both return the previous value of the bit
+    bool testAndSet(size_t pos)
+    {
+        return (words_[pos / BITS_IN_WORD].fetchOr(bitMask(pos)) & bitMask(pos)) != 0;
+    }
+
+    bool testAndClear(size_t pos)
+    {
+        return (words_[pos / BITS_IN_WORD].fetchAnd(static_cast<word_type>(~bitMask(pos))) & bitMask(pos)) != 0;
+    }
+
+    void set(size_t pos) {testAndSet(pos);};
+    void reset(size_t pos) {testAndClear(pos);};
+
+    //whole word updates, word i holds bits [i * BITS_IN_WORD, (i + 1) * BITS_IN_WORD), the previous word is returned
+    word_type fetchOr(size_t i, word_type mask)
+    {
+        return withoutPadding(i, words_[i].fetchOr(mask));
+    }
+
+    word_type fetchAnd(size_t i, word_type mask)
+    {
+        return withoutPadding(i, words_[i].fetchAnd(static_cast<word_type>(mask | (i == N_WORDS - 1 ? paddingMask() : 0))));
+    }
+
+    word_type word(size_t i) const
+    {
+        return withoutPadding(i, words_[i].load());
+    }
+
+    //sets the first clear bit at or after word from_pos / BITS_IN_WORD (wrapping around) and returns its position,
+    //N if every bit is set, spreading from_pos over callers keeps them off each others words
+    size_t acquireFirstClear(size_t from_pos = 0)
+    {
+        size_t first = from_pos < N ? from_pos / BITS_IN_WORD : 0;
+        for (size_t n = 0; n < N_WORDS; n++)
+        {
+            size_t i = first + n < N_WORDS ? first + n : first + n - N_WORDS;
+            size_t pos = claimInWord(i);
+            if (pos != N)
+            {
+                return pos;
+            }
+        }
+        return N;
+    }
+
+    //snapshot, exact only while no other writer is active
+    size_t count() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < N_WORDS; i++)
+        {
+            n += aux::popcount(word(i));
+        }
+        return n;
+    }
+
+    bool full() const {return count() == N;};
+
+    void clear()
+    {
+        for (size_t i = 0; i < N_WORDS; i++)
+        {
+            words_[i].store(i == N_WORDS - 1 ? paddingMask() : 0);
+        }
+    }
+
+    AtomicBitVector()
+    {
+        words_[N_WORDS - 1].store(paddingMask());
+    }
+
+    AtomicBitVector(const AtomicBitVector&) = delete;
+    AtomicBitVector& operator=(const AtomicBitVector&) = delete;
+};
+
+}
+
+#endif
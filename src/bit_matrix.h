@@ -0,0 +1,300 @@
+#ifndef ASTL_BIT_MATRIX_H
+#define ASTL_BIT_MATRIX_H
+
+#include "vector.h"
+#include "span.h"
+#include "bit_operations.h"
+
+namespace astl
+{
+
+namespace aux
+{
+#if defined(ARDUINO)
+typedef uint8_t MatrixBlock;
+#else
+typedef uint64_t MatrixBlock;
+#endif
+
+//transposes a square tile of sizeof(T) * 8 rows in place, row i bit j ends up as row j bit i, on 64 bit blocks this is
+//the 64x64 kernel and on bytes the 8x8 one. Each step swaps the upper columns of the top rows with the lower columns of
+//the bottom rows of every 2w x 2w sub tile
+template<class T>
+inline void transposeSquare(T* a)
+{
+    const size_t bits_in_block = sizeof(T) * 8;
+    for (size_t w = bits_in_block / 2; w != 0; w = w / 2)
+    {
+        T mask = lowBitsMask<T>(w);
+        for (size_t s = 2 * w; s < bits_in_block; s = s * 2)
+        {
+            mask = static_cast<T>(mask | (mask << s));
+        }
+        for (size_t k = 0; k < bits_in_block; k = (k + w + 1) & ~w)
+        {
+            T t = static_cast<T>(((a[k] >> w) ^ a[k + w]) & mask);
+            a[k + w] = static_cast<T>(a[k + w] ^ t);
+            a[k] = static_cast<T>(a[k] ^ (t << w));
+        }
+    }
+}
+
+
+//compile time shapes take no room, 0 x 0 means the shape is set at run time
+template<size_t Rows, size_t Cols>
+struct MatrixShape
+{
+    static constexpr size_t rows() {return Rows;};
+    static constexpr size_t cols() {return Cols;};
+    bool setShape(size_t rows, size_t cols) {return rows == Rows && cols == Cols;};
+};
+
+template<>
+struct MatrixShape<0, 0>
+{
+    size_t rows_;
+    size_t cols_;
+
+    size_t rows() const {return rows_;};
+    size_t cols() const {return cols_;};
+
+    bool setShape(size_t rows, size_t cols)
+    {
+        rows_ = rows;
+        cols_ = cols;
+        return true;
+    }
+
+    MatrixShape()
+        :rows_(0), cols_(0) {};
+};
+
+template<size_t Rows, size_t Cols, class T>
+struct MatrixAllocator
+{
+    typedef FixedSizeAllocator<T, Rows * ((Cols + sizeof(T) * 8 - 1) / (sizeof(T) * 8))> type;
+};
+
+template<class T>
+struct MatrixAllocator<0, 0, T>
+{
+    typedef HeapAllocator<T> type;
+};
+}
+
+
+//bit matrix in one allocation, each row starts on a block boundary and the padding past cols() is kept clear,
+//BitMatrix<> takes its shape at construction, BitMatrix<Rows, Cols> is sized at compile time and needs no heap
+template<size_t Rows = 0, size_t Cols = 0, class T = aux::MatrixBlock, class Allocator = typename aux::MatrixAllocator<Rows, Cols, T>::type>
+class BitMatrix : private aux::MatrixShape<Rows, Cols>
+{
+    static_assert((Rows == 0) == (Cols == 0), "BitMatrix needs both dimensions at compile time or neither");
+
+    static const size_t BITS_IN_BLOCK = sizeof(T) * 8;
+
+    Vector<T, Allocator, allocationPolicyFixed> blocks_;
+
+    static T bitMask(size_t col) {return static_cast<T>(static_cast<T>(1) << (col % BITS_IN_BLOCK));};
+
+public:
+    using aux::MatrixShape<Rows, Cols>::rows;
+    using aux::MatrixShape<Rows, Cols>::cols;
+
+    //blocks per row
+    size_t stride() const {return (cols() + BITS_IN_BLOCK - 1) / BITS_IN_BLOCK;};
+    T* data() {return blocks_.data();};
+    const T* data() const {return blocks_.data();};
+
+    Span<T> row(size_t r) {return Span<T>(blocks_.data() + r * stride(), stride());};
+    Span<const T> row(size_t r) const {return Span<const T>(blocks_.data() + r * stride(), stride());};
+
+    bool test(size_t r, size_t c) const {return (blocks_[r * stride() + c / BITS_IN_BLOCK] & bitMask(c)) != 0;};
+    bool operator()(size_t r, size_t c) const {return test(r, c);};
+
+    void set(size_t r, size_t c)
+    {
+        T& block = blocks_[r * stride() + c / BITS_IN_BLOCK];
+        block = static_cast<T>(block | bitMask(c));
+    }
+
+    void reset(size_t r, size_t c)
+    {
+        T& block = blocks_[r * stride() + c / BITS_IN_BLOCK];
+        block = static_cast<T>(block & ~bitMask(c));
+    }
+
+    void set(size_t r, size_t c, bool value)
+    {
+        if (value)
+        {
+            set(r, c);
+        }
+        else
+        {
+            reset(r, c);
+        }
+    }
+
+    void flip(size_t r, size_t c)
+    {
+        T& block = blocks_[r * stride() + c / BITS_IN_BLOCK];
+        block = static_cast<T>(block ^ bitMask(c));
+    }
+
+    void clear()
+    {
+        if (blocks_.size() != 0)
+        {
+            ::memset(blocks_.data(), 0, blocks_.size() * sizeof(T));
+        }
+    }
+
+    //sets a new shape with every bit clear, compile time shapes only accept their own
+    bool resize(size_t rows, size_t cols)
+    {
+        size_t n_blocks = rows * ((cols + BITS_IN_BLOCK - 1) / BITS_IN_BLOCK);
+        size_t old_rows = this->rows();
+        size_t old_cols = this->cols();
+        if (!this->setShape(rows, cols))
+        {
+            return false;
+        }
+        if (!blocks_.resizeDefaultInit(n_blocks))
+        {
+            this->setShape(old_rows, old_cols);
+            return false;
+        }
+        clear();
+        return true;
+    }
+
+
+    //row dst op= row src, or op= a row of another matrix with the same number of columns
+    void orRow(size_t dst, size_t src) {orRow(dst, row(src));};
+    void andRow(size_t dst, size_t src) {andRow(dst, row(src));};
+    void xorRow(size_t dst, size_t src) {xorRow(dst, row(src));};
+
+    void orRow(size_t dst, Span<const T> src) {aux::combineBlocks(row(dst).data(), src.data(), stride(), aux::BitOr());};
+    void andRow(size_t dst, Span<const T> src) {aux::combineBlocks(row(dst).data(), src.data(), stride(), aux::BitAnd());};
+    void xorRow(size_t dst, Span<const T> src) {aux::combineBlocks(row(dst).data(), src.data(), stride(), aux::BitXor());};
+
+    size_t rowCount(size_t r) const {return aux::popcountBlocks(row(r).data(), stride());};
+    size_t count() const {return aux::popcountBlocks(blocks_.data(), blocks_.size());};
+
+    size_t columnCount(size_t c) const
+    {
+        size_t n = 0;
+        for (size_t r = 0; r < rows(); r++)
+        {
+            n += test(r, c) ? 1 : 0;
+        }
+        return n;
+    }
+
+    //counts of every column into out[0, cols()), one pass over the set bits
+    void columnCounts(size_t* out) const
+    {
+        ::memset(out, 0, cols() * sizeof(size_t));
+        const T* data = blocks_.data();
+        for (size_t r = 0; r < rows(); r++, data += stride())
+        {
+            for (size_t b = 0; b < stride(); b++)
+            {
+                for (T block = data[b]; block != 0; block = static_cast<T>(block & (block - 1)))
+                {
+                    out[b * BITS_IN_BLOCK + aux::countTrailingZeros(block)]++;
+                }
+            }
+        }
+    }
+
+
+    //out becomes cols() x rows(), square tiles of BITS_IN_BLOCK bits are transposed with aux::transposeSquare
+    template<class Matrix>
+    bool transpose(Matrix& out) const
+    {
+        if (!out.resize(cols(), rows()))
+        {
+            return false;
+        }
+        T tile[BITS_IN_BLOCK];
+        for (size_t tile_row = 0; tile_row * BITS_IN_BLOCK < rows(); tile_row++)
+        {
+            for (size_t tile_col = 0; tile_col < stride(); tile_col++)
+            {
+                for (size_t i = 0; i < BITS_IN_BLOCK; i++)
+                {
+                    size_t r = tile_row * BITS_IN_BLOCK + i;
+                    tile[i] = r < rows() ? blocks_[r * stride() + tile_col] : 0;
+                }
+                aux::transposeSquare(tile);
+                for (size_t j = 0; j < BITS_IN_BLOCK && tile_col * BITS_IN_BLOCK + j < cols(); j++)
+                {
+                    out.row(tile_col * BITS_IN_BLOCK + j)[tile_row] = tile[j];
+                }
+            }
+        }
+        return true;
+    }
+
+    //reachability of a square adjacency matrix in place (Warshall on whole rows), a path of length 0 is not added
+    bool transitiveClosure()
+    {
+        if (rows() != cols())
+        {
+            return false;
+        }
+        for (size_t k = 0; k < rows(); k++)
+        {
+            Span<const T> row_k = row(k);
+            for (size_t i = 0; i < rows(); i++)
+            {
+                if (test(i, k))
+                {
+                    orRow(i, row_k);
+                }
+            }
+        }
+        return true;
+    }
+
+
+    BitMatrix()
+    {
+        resize(Rows, Cols);
+    }
+
+    //run time shape, only for BitMatrix<0, 0, ...>
+    BitMatrix(size_t rows, size_t cols)
+    {
+        resize(rows, cols);
+    }
+};
+
+
+//boolean product out = a * b, row i of out is the or of the rows of b selected by row i of a
+template<class MatrixA, class MatrixB, class MatrixOut>
+inline bool multiply(const MatrixA& a, const MatrixB& b, MatrixOut& out)
+{
+    if (a.cols() != b.rows() || !out.resize(a.rows(), b.cols()))
+    {
+        return false;
+    }
+    const size_t bits_in_block = sizeof(a.row(0)[0]) * 8;
+    for (size_t i = 0; i < a.rows(); i++)
+    {
+        auto row_a = a.row(i);
+        for (size_t k = 0; k < row_a.size(); k++)
+        {
+            for (auto block = row_a[k]; block != 0; block = static_cast<decltype(block)>(block & (block - 1)))
+            {
+                out.orRow(i, b.row(k * bits_in_block + aux::countTrailingZeros(block)));
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,531 @@
+#ifndef ASTL_BIT_OPERATIONS_H
+#define ASTL_BIT_OPERATIONS_H
+
+#include "memory_operations.h"
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(__AVX512F__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace astl
+{
+
+namespace aux
+{
+
+//x must be non zero for the count/find helpers
+template<class T>
+inline size_t countTrailingZeros(T x)
+{
+    if (sizeof(T) <= sizeof(unsigned int))
+    {
+        return __builtin_ctz(static_cast<unsigned int>(x));
+    }
+    else if (sizeof(T) <= sizeof(unsigned long))
+    {
+        return __builtin_ctzl(static_cast<unsigned long>(x));
+    }
+    return __builtin_ctzll(static_cast<unsigned long long>(x));
+}
+
+
+template<class T>
+inline size_t countLeadingZeros(T x)
+{
+    if (sizeof(T) <= sizeof(unsigned int))
+    {
+        return __builtin_clz(static_cast<unsigned int>(x)) - (sizeof(unsigned int) - sizeof(T)) * 8;
+    }
+    else if (sizeof(T) <= sizeof(unsigned long))
+    {
+        return __builtin_clzl(static_cast<unsigned long>(x)) - (sizeof(unsigned long) - sizeof(T)) * 8;
+    }
+    return __builtin_clzll(static_cast<unsigned long long>(x));
+}
+
+
+//index of the most significant set bit
+template<class T>
+inline size_t findLastSet(T x)
+{
+    return sizeof(T) * 8 - 1 - countLeadingZeros(x);
+}
+
+
+#if defined(ARDUINO)
+//avr has no popcount instruction, a nibble table beats the libgcc bit loop
+static const uint8_t NIBBLE_POPCOUNT[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+template<class T>
+inline size_t popcount(T x)
+{
+    size_t n = 0;
+    while (x != 0)
+    {
+        n += NIBBLE_POPCOUNT[x & 0x0F];
+        x = x >> 4;
+    }
+    return n;
+}
+#else
+template<class T>
+inline size_t popcount(T x)
+{
+    if (sizeof(T) <= sizeof(unsigned int))
+    {
+        return __builtin_popcount(static_cast<unsigned int>(x));
+    }
+    else if (sizeof(T) <= sizeof(unsigned long))
+    {
+        return __builtin_popcountl(static_cast<unsigned long>(x));
+    }
+    return __builtin_popcountll(static_cast<unsigned long long>(x));
+}
+#endif
+
+
+//position of the k-th (from 0) set bit of x, x must have more than k bits set
+template<class T>
+inline size_t selectInBlock(T x, size_t k)
+{
+#if defined(__BMI2__)
+    if (sizeof(T) == sizeof(uint64_t))
+    {
+        return countTrailingZeros(_pdep_u64(static_cast<uint64_t>(1) << k, static_cast<uint64_t>(x)));
+    }
+#endif
+    for (; k > 0; k--)
+    {
+        x = x & (x - 1);
+    }
+    return countTrailingZeros(x);
+}
+
+
+//mask of the n lowest bits, n must be smaller than the width of T
+template<class T>
+inline T lowBitsMask(size_t n)
+{
+    return n == 0 ? static_cast<T>(0) : static_cast<T>(static_cast<T>(~static_cast<T>(0)) >> (sizeof(T) * 8 - n));
+}
+
+
+#if defined(__AVX2__)
+//nibble lookup with pshufb, byte counts are summed into 64 bit lanes by psadbw (W. Mula)
+inline __m256i popcountLanes(__m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+    __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+inline size_t sumLanes(__m256i v)
+{
+    return _mm256_extract_epi64(v, 0) + _mm256_extract_epi64(v, 1) + _mm256_extract_epi64(v, 2) + _mm256_extract_epi64(v, 3);
+}
+#endif
+
+
+//word operations for the bulk kernels, one overload per register width
+struct BitAnd
+{
+    template<class T>
+    T operator()(T a, T b) const {return static_cast<T>(a & b);};
+#if defined(__SSE2__)
+    __m128i operator()(__m128i a, __m128i b) const {return _mm_and_si128(a, b);};
+#endif
+#if defined(__AVX2__)
+    __m256i operator()(__m256i a, __m256i b) const {return _mm256_and_si256(a, b);};
+#endif
+#if defined(__AVX512F__)
+    __m512i operator()(__m512i a, __m512i b) const {return _mm512_and_si512(a, b);};
+#endif
+};
+
+struct BitOr
+{
+    template<class T>
+    T operator()(T a, T b) const {return static_cast<T>(a | b);};
+#if defined(__SSE2__)
+    __m128i operator()(__m128i a, __m128i b) const {return _mm_or_si128(a, b);};
+#endif
+#if defined(__AVX2__)
+    __m256i operator()(__m256i a, __m256i b) const {return _mm256_or_si256(a, b);};
+#endif
+#if defined(__AVX512F__)
+    __m512i operator()(__m512i a, __m512i b) const {return _mm512_or_si512(a, b);};
+#endif
+};
+
+struct BitXor
+{
+    template<class T>
+    T operator()(T a, T b) const {return static_cast<T>(a ^ b);};
+#if defined(__SSE2__)
+    __m128i operator()(__m128i a, __m128i b) const {return _mm_xor_si128(a, b);};
+#endif
+#if defined(__AVX2__)
+    __m256i operator()(__m256i a, __m256i b) const {return _mm256_xor_si256(a, b);};
+#endif
+#if defined(__AVX512F__)
+    __m512i operator()(__m512i a, __m512i b) const {return _mm512_xor_si512(a, b);};
+#endif
+};
+
+struct BitAndNot
+{
+    template<class T>
+    T operator()(T a, T b) const {return static_cast<T>(a & ~b);};
+#if defined(__SSE2__)
+    __m128i operator()(__m128i a, __m128i b) const {return _mm_andnot_si128(b, a);};
+#endif
+#if defined(__AVX2__)
+    __m256i operator()(__m256i a, __m256i b) const {return _mm256_andnot_si256(b, a);};
+#endif
+#if defined(__AVX512F__)
+    __m512i operator()(__m512i a, __m512i b) const {return _mm512_andnot_si512(b, a);};
+#endif
+};
+
+
+//dst = op(dst, src) over n_bytes, the buffers may be unaligned
+template<class Op>
+inline void combineBytes(uint8_t* dst, const uint8_t* src, size_t n_bytes, Op op)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= n_bytes; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), op(a, b));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= n_bytes; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), op(a, b));
+    }
+#endif
+#if !defined(ARDUINO)
+    for (; i + sizeof(uint64_t) <= n_bytes; i += sizeof(uint64_t))
+    {
+        uint64_t a;
+        uint64_t b;
+        ::memcpy(&a, dst + i, sizeof(uint64_t));
+        ::memcpy(&b, src + i, sizeof(uint64_t));
+        a = op(a, b);
+        ::memcpy(dst + i, &a, sizeof(uint64_t));
+    }
+#endif
+    for (; i < n_bytes; i++)
+    {
+        dst[i] = op(dst[i], src[i]);
+    }
+}
+
+
+inline void flipBytes(uint8_t* dst, size_t n_bytes)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi8(-1);
+    for (; i + 32 <= n_bytes; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(a, ones));
+    }
+#elif defined(__SSE2__)
+    const __m128i ones = _mm_set1_epi8(-1);
+    for (; i + 16 <= n_bytes; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, ones));
+    }
+#endif
+    for (; i < n_bytes; i++)
+    {
+        dst[i] = ~dst[i];
+    }
+}
+
+
+//popcount(op(a, b)) without writing the result anywhere
+template<class Op>
+inline size_t combineCountBytes(const uint8_t* a, const uint8_t* b, size_t n_bytes, Op op)
+{
+    size_t n = 0;
+    size_t i = 0;
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512F__)
+    __m512i acc512 = _mm512_setzero_si512();
+    for (; i + 64 <= n_bytes; i += 64)
+    {
+        acc512 = _mm512_add_epi64(acc512, _mm512_popcnt_epi64(op(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))));
+    }
+    n += _mm512_reduce_add_epi64(acc512);
+#elif defined(__AVX2__)
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 32 <= n_bytes; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc256 = _mm256_add_epi64(acc256, popcountLanes(op(va, vb)));
+    }
+    n += sumLanes(acc256);
+#endif
+#if !defined(ARDUINO)
+    for (; i + sizeof(uint64_t) <= n_bytes; i += sizeof(uint64_t))
+    {
+        uint64_t wa;
+        uint64_t wb;
+        ::memcpy(&wa, a + i, sizeof(uint64_t));
+        ::memcpy(&wb, b + i, sizeof(uint64_t));
+        n += popcount(op(wa, wb));
+    }
+#endif
+    for (; i < n_bytes; i++)
+    {
+        n += popcount(op(a[i], b[i]));
+    }
+    return n;
+}
+
+
+inline size_t popcountBytes(const uint8_t* data, size_t n_bytes)
+{
+    size_t n = 0;
+    size_t i = 0;
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512F__)
+    __m512i acc512 = _mm512_setzero_si512();
+    for (; i + 64 <= n_bytes; i += 64)
+    {
+        acc512 = _mm512_add_epi64(acc512, _mm512_popcnt_epi64(_mm512_loadu_si512(data + i)));
+    }
+    n += _mm512_reduce_add_epi64(acc512);
+#elif defined(__AVX2__)
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i + 32 <= n_bytes; i += 32)
+    {
+        acc256 = _mm256_add_epi64(acc256, popcountLanes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))));
+    }
+    n += sumLanes(acc256);
+#endif
+#if !defined(ARDUINO)
+    for (; i + sizeof(uint64_t) <= n_bytes; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        ::memcpy(&word, data + i, sizeof(uint64_t));
+        n += popcount(word);
+    }
+#endif
+    for (; i < n_bytes; i++)
+    {
+        n += popcount(data[i]);
+    }
+    return n;
+}
+
+
+template<class T>
+inline size_t popcountBlocks(const T* data, size_t n_blocks)
+{
+    return popcountBytes(reinterpret_cast<const uint8_t*>(data), n_blocks * sizeof(T));
+}
+
+
+template<class T, class Op>
+inline void combineBlocks(T* dst, const T* src, size_t n_blocks, Op op)
+{
+    combineBytes(reinterpret_cast<uint8_t*>(dst), reinterpret_cast<const uint8_t*>(src), n_blocks * sizeof(T), op);
+}
+
+
+template<class T, class Op>
+inline size_t combineCountBlocks(const T* a, const T* b, size_t n_blocks, Op op)
+{
+    return combineCountBytes(reinterpret_cast<const uint8_t*>(a), reinterpret_cast<const uint8_t*>(b), n_blocks * sizeof(T), op);
+}
+
+
+//set bits in [begin_bit, end_bit) of a block array
+template<class T>
+inline size_t popcountRange(const T* data, size_t begin_bit, size_t end_bit)
+{
+    const size_t bits_in_block = sizeof(T) * 8;
+    if (begin_bit >= end_bit)
+    {
+        return 0;
+    }
+    size_t first = begin_bit / bits_in_block;
+    size_t last = end_bit / bits_in_block;
+    T head = data[first] & static_cast<T>(~lowBitsMask<T>(begin_bit % bits_in_block));
+    if (first == last)
+    {
+        return popcount(static_cast<T>(head & lowBitsMask<T>(end_bit % bits_in_block)));
+    }
+    size_t n = popcount(head) + popcountBlocks(data + first + 1, last - first - 1);
+    if (end_bit % bits_in_block != 0)
+    {
+        n += popcount(static_cast<T>(data[last] & lowBitsMask<T>(end_bit % bits_in_block)));
+    }
+    return n;
+}
+
+
+#if !defined(ARDUINO)
+#if defined(__AVX2__)
+static const size_t FUNNEL_VECTOR_BYTES = 32;
+#else
+static const size_t FUNNEL_VECTOR_BYTES = 16;
+#endif
+
+//gcc/clang vector of blocks, shifts by a scalar compile to psll/psrl on the host
+template<class T>
+struct BlockVector
+{
+    typedef T type __attribute__((vector_size(FUNNEL_VECTOR_BYTES)));
+};
+#endif
+
+
+//out[k] = in[k] << shift | in[k - 1] >> (bits - shift) for k in [0, n), in[-1] read as 0 and 0 < shift < bits,
+//runs from the top so out may be in moved up by any number of blocks
+template<class T>
+inline void funnelShiftUp(T* out, const T* in, size_t n, size_t shift)
+{
+    const size_t bits_in_block = sizeof(T) * 8;
+    size_t k = n;
+#if !defined(ARDUINO)
+    typedef typename BlockVector<T>::type Vec;
+    const size_t blocks_in_vector = sizeof(Vec) / sizeof(T);
+    while (k >= blocks_in_vector + 1)
+    {
+        k -= blocks_in_vector;
+        Vec hi;
+        Vec lo;
+        ::memcpy(&hi, in + k, sizeof(Vec));
+        ::memcpy(&lo, in + k - 1, sizeof(Vec));
+        hi = (hi << static_cast<int>(shift)) | (lo >> static_cast<int>(bits_in_block - shift));
+        ::memcpy(out + k, &hi, sizeof(Vec));
+    }
+#endif
+    while (k > 1)
+    {
+        k--;
+        out[k] = static_cast<T>(in[k] << shift) | static_cast<T>(in[k - 1] >> (bits_in_block - shift));
+    }
+    if (n != 0)
+    {
+        out[0] = static_cast<T>(in[0] << shift);
+    }
+}
+
+
+//out[k] = in[k] >> shift | in[k + 1] << (bits - shift) for k in [0, n), in[n] read as 0 and 0 < shift < bits,
+//runs from the bottom so out may be in moved down by any number of blocks
+template<class T>
+inline void funnelShiftDown(T* out, const T* in, size_t n, size_t shift)
+{
+    const size_t bits_in_block = sizeof(T) * 8;
+    size_t k = 0;
+#if !defined(ARDUINO)
+    typedef typename BlockVector<T>::type Vec;
+    const size_t blocks_in_vector = sizeof(Vec) / sizeof(T);
+    for (; k + blocks_in_vector < n; k += blocks_in_vector)
+    {
+        Vec lo;
+        Vec hi;
+        ::memcpy(&lo, in + k, sizeof(Vec));
+        ::memcpy(&hi, in + k + 1, sizeof(Vec));
+        lo = (lo >> static_cast<int>(shift)) | (hi << static_cast<int>(bits_in_block - shift));
+        ::memcpy(out + k, &lo, sizeof(Vec));
+    }
+#endif
+    for (; k + 1 < n; k++)
+    {
+        out[k] = static_cast<T>(in[k] >> shift) | static_cast<T>(in[k + 1] << (bits_in_block - shift));
+    }
+    if (n != 0)
+    {
+        out[n - 1] = static_cast<T>(in[n - 1] >> shift);
+    }
+}
+
+
+//reads width (at most 32) bits starting at bit pos of a block array, the field may straddle several blocks
+template<class T>
+inline uint32_t getBits(const T* data, size_t pos, size_t width)
+{
+    const size_t bits_in_block = sizeof(T) * 8;
+    uint32_t value = 0;
+    size_t done = 0;
+    while (done < width)
+    {
+        size_t offset = (pos + done) % bits_in_block;
+        size_t take = bits_in_block - offset < width - done ? bits_in_block - offset : width - done;
+        T field = static_cast<T>(data[(pos + done) / bits_in_block] >> offset);
+        if (take < bits_in_block)
+        {
+            field = field & lowBitsMask<T>(take);
+        }
+        value |= static_cast<uint32_t>(field) << done;
+        done += take;
+    }
+    return value;
+}
+
+
+template<class T>
+inline void setBits(T* data, size_t pos, size_t width, uint32_t value)
+{
+    const size_t bits_in_block = sizeof(T) * 8;
+    size_t done = 0;
+    while (done < width)
+    {
+        size_t offset = (pos + done) % bits_in_block;
+        size_t take = bits_in_block - offset < width - done ? bits_in_block - offset : width - done;
+        T mask = take < bits_in_block ? lowBitsMask<T>(take) : static_cast<T>(~static_cast<T>(0));
+        T& block = data[(pos + done) / bits_in_block];
+        block = static_cast<T>(block & ~static_cast<T>(mask << offset)) | static_cast<T>((static_cast<T>(value >> done) & mask) << offset);
+        done += take;
+    }
+}
+
+
+//first index in [i, n_blocks) whose block differs from skip_value (all zeros or all ones), n_blocks if none
+template<class T>
+inline size_t skipBlocks(const T* data, size_t i, size_t n_blocks, T skip_value)
+{
+#if !defined(ARDUINO)
+    if (sizeof(T) < sizeof(uint64_t))
+    {
+        const size_t blocks_in_word = sizeof(uint64_t) / sizeof(T);
+        const uint64_t skip_word = skip_value == 0 ? 0 : ~static_cast<uint64_t>(0);
+        while (i + blocks_in_word <= n_blocks)
+        {
+            uint64_t word;
+            ::memcpy(&word, data + i, sizeof(uint64_t));
+            if (word != skip_word)
+            {
+                break;
+            }
+            i += blocks_in_word;
+        }
+    }
+#endif
+    while (i < n_blocks && data[i] == skip_value)
+    {
+        i++;
+    }
+    return i;
+}
+
+}
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef ASTL_BITVECTOR_H
 #define ASTL_BITVECTOR_H
 #include "vector.h"
+#include "bit_operations.h"
 
 namespace astl
 {
@@ -299,6 +300,114 @@ class BitVector
 		}      
     }
        
+    //bits past size() in the last block are not kept clear, so every scan masks them
+    T lastBlockMask() const
+    {
+        const size_t res_bits = size_ % BitBlock<T>::BITS_IN_BLOCK;
+        return res_bits == 0 ? BitBlock<T>::FULL_BYTE : aux::lowBitsMask<T>(res_bits);
+    }
+
+    T lastBlock() const
+    {
+        return data_[sizeBytes() - 1] & lastBlockMask();
+    }
+
+    //for the whole block ops that could otherwise set padding bits, == and resize read them
+    void clearPadding()
+    {
+        if (size_ % BitBlock<T>::BITS_IN_BLOCK != 0)
+        {
+            data_[sizeBytes() - 1] = lastBlock();
+        }
+    }
+
+    size_t findNext(size_t pos, T skip_value) const
+    {
+        if (pos >= size_)
+        {
+            return size_;
+        }
+        const size_t size_bytes = sizeBytes();
+        size_t i = pos / BitBlock<T>::BITS_IN_BLOCK;
+        T block = (data_[i] ^ skip_value) & (BitBlock<T>::FULL_BYTE << (pos % BitBlock<T>::BITS_IN_BLOCK));
+        if (block == 0)
+        {
+            i = aux::skipBlocks(data_, i + 1, size_bytes, skip_value);
+            if (i == size_bytes)
+            {
+                return size_;
+            }
+            block = data_[i] ^ skip_value;
+        }
+        size_t found = i * BitBlock<T>::BITS_IN_BLOCK + aux::countTrailingZeros(block);
+        return found < size_ ? found : size_;
+    }
+       
+    //moves bits [pos, size_) up by n in one pass over the blocks, capacity must already hold size_ + n bits
+    //and [pos, pos + n) is left for the caller to write
+    void shiftTailUp(size_t pos, size_t n)
+    {
+        if (pos == size_)
+        {
+            return;
+        }
+        const size_t old_blocks = getNumBytes(size_);
+        const size_t new_blocks = getNumBytes(size_ + n);
+        const size_t first = pos / BitBlock<T>::BITS_IN_BLOCK;
+        const size_t block_shift = n / BitBlock<T>::BITS_IN_BLOCK;
+        const size_t bit_shift = n % BitBlock<T>::BITS_IN_BLOCK;
+        const T low_mask = aux::lowBitsMask<T>(pos % BitBlock<T>::BITS_IN_BLOCK);
+        const T low = data_[first] & low_mask;
+        ::memset(data_ + old_blocks, 0, (new_blocks - old_blocks) * sizeof(T));
+        if (bit_shift == 0)
+        {
+            ::memmove(data_ + first + block_shift, data_ + first, (old_blocks - first) * sizeof(T));
+        }
+        else
+        {
+            aux::funnelShiftUp(data_ + first + block_shift, data_ + first, new_blocks - first - block_shift, bit_shift);
+        }
+        data_[first] = (data_[first] & static_cast<T>(~low_mask)) | low;
+    }
+
+    //moves bits [pos + n, size_) down to pos, overwriting [pos, pos + n)
+    void shiftTailDown(size_t pos, size_t n)
+    {
+        if (pos + n == size_)
+        {
+            return;
+        }
+        const size_t old_blocks = getNumBytes(size_);
+        const size_t first = pos / BitBlock<T>::BITS_IN_BLOCK;
+        const size_t block_shift = n / BitBlock<T>::BITS_IN_BLOCK;
+        const size_t bit_shift = n % BitBlock<T>::BITS_IN_BLOCK;
+        const T low_mask = aux::lowBitsMask<T>(pos % BitBlock<T>::BITS_IN_BLOCK);
+        const T low = data_[first] & low_mask;
+        if (bit_shift == 0)
+        {
+            ::memmove(data_ + first, data_ + first + block_shift, (old_blocks - first - block_shift) * sizeof(T));
+        }
+        else
+        {
+            aux::funnelShiftDown(data_ + first, data_ + first + block_shift, old_blocks - first - block_shift, bit_shift);
+        }
+        data_[first] = (data_[first] & static_cast<T>(~low_mask)) | low;
+    }
+
+    //applies op to the blocks both vectors share, the partial last one with x zero extended
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2, class Op>
+    size_t combine(const BitVector<T, Allocator2, allocPolicy2>& x, Op op)
+    {
+        const size_t common = size_ < x.size() ? size_ : x.size();
+        const size_t full = common / BitBlock<T>::BITS_IN_BLOCK;
+        aux::combineBlocks(data_, x.data(), full, op);
+        if (common % BitBlock<T>::BITS_IN_BLOCK != 0)
+        {
+            data_[full] = op(data_[full], static_cast<T>(x.data()[full] & aux::lowBitsMask<T>(common % BitBlock<T>::BITS_IN_BLOCK)));
+        }
+        return common;
+    }
+       
 public:
     
     T* data() {return data_;};
@@ -313,18 +422,12 @@ public:
     
     size_t count() const
     {
-        size_t ct = 0;
         const size_t size_bytes = sizeBytes();
-        for (size_t i = 0; i < size_bytes; i++)
+        if (size_bytes == 0)
         {
-            T byte_i = data_[i];
-            while (byte_i != 0)
-            {
-                ct += (byte_i & BitBlock<T>::UNIT_BLOCK);
-                byte_i >> 1;
-            }
-        }    
-        return ct;
+            return 0;
+        }
+        return aux::popcountBlocks(data_, size_bytes - 1) + aux::popcount(lastBlock());
     }
     
     
@@ -335,83 +438,239 @@ public:
         {
             return true;
         }
-        
-        for (size_t i = 0; i < size_bytes - 1; i++)
+        return aux::skipBlocks(data_, 0, size_bytes - 1, BitBlock<T>::FULL_BYTE) == size_bytes - 1 && lastBlock() == lastBlockMask();
+    }
+     
+    
+    bool none() const
+    {
+        return !any();
+    }
+
+    bool any() const
+    {
+        const size_t size_bytes = sizeBytes();
+        if (size_bytes == 0)
         {
-            if (data_[i] != BitBlock<T>::FULL_BYTE)
+            return false;
+        }
+        return aux::skipBlocks(data_, 0, size_bytes - 1, static_cast<T>(0)) != size_bytes - 1 || lastBlock() != 0;
+    }
+
+
+    //the find functions return size() when there is no such bit
+    size_t findNextSet(size_t pos) const
+    {
+        return findNext(pos, static_cast<T>(0));
+    }
+
+    size_t findFirstSet() const {return findNextSet(0);};
+
+    size_t findNextClear(size_t pos) const
+    {
+        return findNext(pos, BitBlock<T>::FULL_BYTE);
+    }
+
+    size_t findFirstClear() const {return findNextClear(0);};
+
+    size_t findLastSet() const
+    {
+        size_t i = sizeBytes();
+        if (i == 0)
+        {
+            return size_;
+        }
+        T block = lastBlock();
+        i--;
+        while (block == 0)
+        {
+            if (i == 0)
             {
-                return false;
+                return size_;
             }
+            i--;
+            block = data_[i];
         }
-        
-        T last_byte = data_.back();
-        for (size_t i = BitBlock<T>::BITS_IN_BLOCK*(size_bytes - 1); i < size_; i++)
+        return i * BitBlock<T>::BITS_IN_BLOCK + aux::findLastSet(block);
+    }
+
+
+    //calls f(pos) for every set bit in increasing order, clear runs are skipped a word at a time
+    template<class Function>
+    void forEachSetBit(Function f) const
+    {
+        const size_t size_bytes = sizeBytes();
+        size_t i = aux::skipBlocks(data_, 0, size_bytes, static_cast<T>(0));
+        while (i < size_bytes)
         {
-            if (!(last_byte & BitBlock<T>::UNIT_BLOCK))
+            T block = i == size_bytes - 1 ? lastBlock() : data_[i];
+            while (block != 0)
             {
-                return false;
+                f(i * BitBlock<T>::BITS_IN_BLOCK + aux::countTrailingZeros(block));
+                block = block & (block - 1);
             }
-            last_byte >> 1;
+            i = aux::skipBlocks(data_, i + 1, size_bytes, static_cast<T>(0));
         }
-        return true;   
     }
-     
     
-    bool none() const
+    
+    //x is read as if zero extended or truncated to size(), the size of *this never changes
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2>
+    BitVector& operator&=(const BitVector<T, Allocator2, allocPolicy2>& x)
+    {
+        size_t common = combine(x, aux::BitAnd());
+        size_t first_clear = getNumBytes(common);
+        if (first_clear < sizeBytes())
+        {
+            ::memset(data_ + first_clear, 0, (sizeBytes() - first_clear) * sizeof(T));
+        }
+        return *this;
+    }
+
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2>
+    BitVector& operator|=(const BitVector<T, Allocator2, allocPolicy2>& x)
+    {
+        combine(x, aux::BitOr());
+        return *this;
+    }
+
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2>
+    BitVector& operator^=(const BitVector<T, Allocator2, allocPolicy2>& x)
+    {
+        combine(x, aux::BitXor());
+        return *this;
+    }
+
+    //clears every bit that is set in x
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2>
+    BitVector& andNot(const BitVector<T, Allocator2, allocPolicy2>& x)
+    {
+        combine(x, aux::BitAndNot());
+        return *this;
+    }
+
+    BitVector& flip()
+    {
+        aux::flipBytes(reinterpret_cast<uint8_t*>(data_), sizeBytes() * sizeof(T));
+        clearPadding();
+        return *this;
+    }
+
+    BitVector& flip(size_t pos)
+    {
+        data_[pos / BitBlock<T>::BITS_IN_BLOCK] ^= BitBlock<T>::UNIT_BLOCK << (pos % BitBlock<T>::BITS_IN_BLOCK);
+        return *this;
+    }
+
+    //moves bits towards higher positions, bits pushed past size() are lost and zeros come in at the front
+    BitVector& operator<<=(size_t n)
     {
         const size_t size_bytes = sizeBytes();
+        const size_t block_shift = n / BitBlock<T>::BITS_IN_BLOCK;
+        const size_t bit_shift = n % BitBlock<T>::BITS_IN_BLOCK;
         if (size_bytes == 0)
         {
-            return true;
+            return *this;
         }
-        
-        for (size_t i = 0; i < size_bytes - 1; i++)
+        if (block_shift >= size_bytes)
         {
-            if (data_[i] != 0)
-            {
-                return false;
-            }
+            ::memset(data_, 0, size_bytes * sizeof(T));
+            return *this;
         }
-        
-        if (data_.back() != 0)
+        if (bit_shift == 0)
         {
-            return false;
+            ::memmove(data_ + block_shift, data_, (size_bytes - block_shift) * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = size_bytes - 1; i > block_shift; i--)
+            {
+                data_[i] = static_cast<T>(data_[i - block_shift] << bit_shift) |
+                    static_cast<T>(data_[i - block_shift - 1] >> (BitBlock<T>::BITS_IN_BLOCK - bit_shift));
+            }
+            data_[block_shift] = static_cast<T>(data_[0] << bit_shift);
         }
-        return true;     
+        ::memset(data_, 0, block_shift * sizeof(T));
+        clearPadding();
+        return *this;
     }
 
-    bool any() const
+    //moves bits towards lower positions, zeros come in at the back
+    BitVector& operator>>=(size_t n)
     {
         const size_t size_bytes = sizeBytes();
+        const size_t block_shift = n / BitBlock<T>::BITS_IN_BLOCK;
+        const size_t bit_shift = n % BitBlock<T>::BITS_IN_BLOCK;
         if (size_bytes == 0)
         {
-            return false;
+            return *this;
         }
-        
-        for (size_t i = 0; i < size_bytes - 1; i++)
+        if (block_shift >= size_bytes)
+        {
+            ::memset(data_, 0, size_bytes * sizeof(T));
+            return *this;
+        }
+        data_[size_bytes - 1] = lastBlock();
+        const size_t n_kept = size_bytes - block_shift;
+        if (bit_shift == 0)
         {
-            if (data_[i] != 0)
+            ::memmove(data_, data_ + block_shift, n_kept * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = 0; i + 1 < n_kept; i++)
             {
-                return true;
+                data_[i] = static_cast<T>(data_[i + block_shift] >> bit_shift) |
+                    static_cast<T>(data_[i + block_shift + 1] << (BitBlock<T>::BITS_IN_BLOCK - bit_shift));
             }
+            data_[n_kept - 1] = static_cast<T>(data_[size_bytes - 1] >> bit_shift);
         }
-        
-        if (data_.back() != 0)
+        ::memset(data_ + n_kept, 0, block_shift * sizeof(T));
+        return *this;
+    }
+
+    //|*this & x| and |*this | x| in one pass without building the result
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2>
+    size_t andCount(const BitVector<T, Allocator2, allocPolicy2>& x) const
+    {
+        const size_t common = size_ < x.size() ? size_ : x.size();
+        const size_t full = common / BitBlock<T>::BITS_IN_BLOCK;
+        size_t n = aux::combineCountBlocks(data_, x.data(), full, aux::BitAnd());
+        if (common % BitBlock<T>::BITS_IN_BLOCK != 0)
         {
-            return true;
+            n += aux::popcount(static_cast<T>(data_[full] & x.data()[full] & aux::lowBitsMask<T>(common % BitBlock<T>::BITS_IN_BLOCK)));
         }
-        return false; 
-    }    
+        return n;
+    }
+
+    template<class Allocator2, AllocationPolicyFunc allocPolicy2>
+    size_t orCount(const BitVector<T, Allocator2, allocPolicy2>& x) const
+    {
+        const size_t common = size_ < x.size() ? size_ : x.size();
+        const size_t full = common / BitBlock<T>::BITS_IN_BLOCK;
+        size_t n = aux::combineCountBlocks(data_, x.data(), full, aux::BitOr());
+        if (common % BitBlock<T>::BITS_IN_BLOCK != 0)
+        {
+            n += aux::popcount(static_cast<T>((data_[full] | x.data()[full]) & aux::lowBitsMask<T>(common % BitBlock<T>::BITS_IN_BLOCK)));
+        }
+        return n + (size_ > x.size() ? aux::popcountRange(data_, common, size_) : aux::popcountRange(x.data(), common, x.size()));
+    }
     
     
 	bool reserve(size_t new_capacity)
 	{
         new_capacity = getNumBytes(new_capacity);
-		if (getNumBytes(capacity_) >= new_capacity)
+		if (capacity_ >= new_capacity)
 		{
 			return true;
 		}
 
+		if (expandInPlace(allocator_, data_, capacity_, new_capacity))
+		{
+			capacity_ = new_capacity;
+			return true;
+		}
+
 		T* new_data = allocator_.allocate(new_capacity);
 		if (new_data == nullptr)
 		{
@@ -455,15 +714,73 @@ public:
                 data_[old_bytes - 1] = data_[old_bytes - 1] | (BitBlock<T>::FULL_BYTE << res_bits);
             }                 
         }
-		else if (val)
+		else if (val && new_size > size_)
 		{
-			data_[old_bytes - 1] = data_[old_bytes - 1] | ((BitBlock<T>::FULL_BYTE << res_bits) & ~(BitBlock<T>::FULL_BYTE << new_res_bits));
+            //growing inside the last block, new_res_bits == 0 means it is now filled to the top
+            T new_bits = BitBlock<T>::FULL_BYTE << res_bits;
+            if (new_res_bits != 0)
+            {
+                new_bits = new_bits & ~(BitBlock<T>::FULL_BYTE << new_res_bits);
+            }
+			data_[old_bytes - 1] = data_[old_bytes - 1] | new_bits;
 		}
 	
 		size_ = new_size;
 		return true;
 	}
 
+
+	//bits between the old and the new size keep whatever the blocks held, e.g. bits left behind by an earlier shrink
+	bool resizeDefaultInit(size_t new_size)
+	{
+		if (!reserve(new_size))
+		{
+			return false;
+		}
+		size_ = new_size;
+		return true;
+	}
+
+
+	//returns blocks for n_bits starting right past the end, commit(k_bits) appends k_bits of them and zero pads the last
+	//used block, size() must be a multiple of the block size or the span is empty and commit fails
+	Span<T> appendUninitialized(size_t n_bits)
+	{
+		if (size_ % BitBlock<T>::BITS_IN_BLOCK != 0)
+		{
+			return Span<T>();
+		}
+		size_t start = getNumBytes(size_) * BitBlock<T>::BITS_IN_BLOCK;
+		if (start + n_bits > capacity_ * BitBlock<T>::BITS_IN_BLOCK)
+		{
+			size_t new_capacity = allocPolicy(start + n_bits);
+			if (!reserve(new_capacity < start + n_bits ? start + n_bits : new_capacity))
+			{
+				return Span<T>();
+			}
+		}
+		return Span<T>(data_ + getNumBytes(size_), getNumBytes(n_bits));
+	}
+
+
+	bool commit(size_t k_bits)
+	{
+		size_t start_byte = getNumBytes(size_);
+		if (size_ % BitBlock<T>::BITS_IN_BLOCK != 0 || getNumBytes(k_bits) > capacity_ - start_byte)
+		{
+			return false;
+		}
+		size_ = start_byte * BitBlock<T>::BITS_IN_BLOCK + k_bits;
+
+		size_t res_bits = size_ % BitBlock<T>::BITS_IN_BLOCK;
+		if (res_bits != 0)
+		{
+			size_t last_byte = size_ / BitBlock<T>::BITS_IN_BLOCK;
+			data_[last_byte] = data_[last_byte] & ~(BitBlock<T>::FULL_BYTE << res_bits);
+		}
+		return true;
+	}
+
     
     void copyToBuffer(bool* buffer) const
     {
@@ -568,31 +885,11 @@ public:
         {
             return false;
         }
-        if (!reserve(size_ + 1))
+        if (!reserve(allocPolicy(size_ + 1)))
         {
             return false;
         }
-
-        size_t num_bytes = getNumBytes(size_);
-        T insert_byte = pos / BitBlock<T>::BITS_IN_BLOCK;
-        size_t insert_bit = pos % BitBlock<T>::BITS_IN_BLOCK;
-
-        T byte_left = (data[insert_byte] >> insert_bit);
-       
-        size_t bits_left = size_ - pos;
-        size_t bits_to_write = BitBlock<T>::BITS_IN_BLOCK - insert_bit;
-
-        if (bits_left > bits_to_write)
-        {
-            size_t bits_written = insert_byte*BitBlock<T>::BITS_IN_BLOCK;
-            writeBitArray(pos+1 + bits_to_write, &data_[insert_byte+1], size_ - bits_written);
-            writeBitArray(pos+1, &byte_left, bits_to_write);
-        }
-        else
-        {
-             writeBitArray(pos+1, &byte_left, bits_left);
-        }
-    
+        shiftTailUp(pos, 1);
         this->operator[](pos) = x;
         size_++;               
         return true;
@@ -604,7 +901,7 @@ public:
     {
         if (x.size() == 0)
         {
-            return 0;
+            return true;
         }
         if (pos > size_)
         {
@@ -623,23 +920,7 @@ public:
 			return insert(pos, y);
 		}
 
-        size_t insert_byte = pos / BitBlock<T>::BITS_IN_BLOCK;
-        size_t insert_bit = pos % BitBlock<T>::BITS_IN_BLOCK;
-        T byte_left = (data_[insert_byte] >> insert_bit);
-       
-        size_t bits_left = size_ - pos;
-        size_t bits_to_write = BitBlock<T>::BITS_IN_BLOCK - insert_bit;
-
-        if (bits_left > bits_to_write)
-        {
-            size_t bits_written = insert_byte*BitBlock<T>::BITS_IN_BLOCK;
-            writeBitArray(pos+x.size() + bits_to_write, &data_[insert_byte+1], size_ - bits_written);
-            writeBitArray(pos+x.size(), &byte_left, bits_to_write);
-        }
-        else
-        {
-             writeBitArray(pos+1, &byte_left, bits_left);
-        }
+        shiftTailUp(pos, x.size());
         writeBitArray(pos, x.data(), x.size());
         size_ += x.size();    
         return true;        
@@ -652,28 +933,7 @@ public:
         {
             return false;
         }
-        if (size_ != pos +1)
-        {
-            size_t erase_byte = pos / BitBlock<T>::BITS_IN_BLOCK;
-            size_t erase_bit = pos % BitBlock<T>::BITS_IN_BLOCK;
-            T byte_left = data_[erase_byte] >> (erase_bit +1);
-
-            size_t bits_left = size_ - pos - 1;
-            size_t bits_to_write = BitBlock<T>::BITS_IN_BLOCK - erase_bit - 1;
-            if (bits_left > bits_to_write)
-            {
-                size_t bits_written = (erase_byte+1)*BitBlock<T>::BITS_IN_BLOCK;
-                writeBitArray(pos + bits_to_write, &data_[erase_byte+1], size_ - bits_written);
-                writeBitArray(pos, &byte_left, bits_to_write);
-            }
-            else
-            {
-                writeBitArray(pos, &byte_left, bits_left);
-            }
-        }
-        this->operator[](size_ - 1) = false;
-        size_--;
-        return true;
+        return erase(pos, pos + 1);
     }
 
 
@@ -689,25 +949,7 @@ public:
             return true;
         }
         
-        if (size_ != end)
-        {
-            size_t end_byte = end / BitBlock<T>::BITS_IN_BLOCK;
-            size_t end_bit = end % BitBlock<T>::BITS_IN_BLOCK;
-            T byte_left = data_[end_byte] >> (end_bit);
-
-            size_t bits_left = size_ - end;
-            size_t bits_to_write = BitBlock<T>::BITS_IN_BLOCK - end_bit;
-            if (bits_left > bits_to_write)
-            {
-                size_t bits_written = (end_byte+1)*BitBlock<T>::BITS_IN_BLOCK;
-                writeBitArray(start + bits_to_write, &data_[end_byte+1], size_ - bits_written);
-                writeBitArray(start, &byte_left, bits_to_write);
-            }
-            else
-            {
-                writeBitArray(start, &byte_left, bits_left);
-            }
-        }
+        shiftTailDown(start, end - start);
         size_ -= (end - start);
         size_t res_bits = size_ % BitBlock<T>::BITS_IN_BLOCK;
         if (res_bits != 0)
@@ -719,6 +961,40 @@ public:
     }
 
 
+    //bits only carry their value, so removing all matching bits leaves a run of the kept value
+    template<class Predicate>
+    size_t eraseIf(Predicate pred)
+    {
+        const bool erase_false = pred(false);
+        const bool erase_true = pred(true);
+        const size_t old_size = size_;
+        if (!erase_false && !erase_true)
+        {
+            return 0;
+        }
+
+        size_t n_kept = 0;
+        if (!erase_false || !erase_true)
+        {
+            size_t n_set = count();
+            n_kept = erase_false ? n_set : size_ - n_set;
+        }
+        resize(0);
+        if (n_kept != 0)
+        {
+            resize(n_kept, erase_false);
+        }
+        return old_size - n_kept;
+    }
+
+
+    template<class Predicate>
+    size_t retain(Predicate pred)
+    {
+        return eraseIf(aux::NegatedPredicate<Predicate>(pred));
+    }
+
+
     bool popBack() 
     {
         if (size_ == 0)
@@ -799,6 +1075,7 @@ public:
     {
         if (allocator_.is_movable)
         {
+            allocator_ = x.allocator_;
             data_ = x.data_;
             size_ = x.size_;
             capacity_ = x.capacity_;
@@ -861,6 +1138,7 @@ public:
             if (allocator_.is_movable)
             {
                 allocator_.deallocate(data_, capacity_);
+                allocator_ = x.allocator_;
                 data_ = x.data_;
                 size_ =  x.size_;
                 capacity_ = x.capacity_;
@@ -960,6 +1238,55 @@ public:
 };
     
     
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy, class Allocator2, AllocationPolicyFunc allocPolicy2>
+BitVector<T, Allocator, allocPolicy> operator&(const BitVector<T, Allocator, allocPolicy>& a, const BitVector<T, Allocator2, allocPolicy2>& b)
+{
+    BitVector<T, Allocator, allocPolicy> result(a);
+    result &= b;
+    return result;
+}
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy, class Allocator2, AllocationPolicyFunc allocPolicy2>
+BitVector<T, Allocator, allocPolicy> operator|(const BitVector<T, Allocator, allocPolicy>& a, const BitVector<T, Allocator2, allocPolicy2>& b)
+{
+    BitVector<T, Allocator, allocPolicy> result(a);
+    result |= b;
+    return result;
+}
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy, class Allocator2, AllocationPolicyFunc allocPolicy2>
+BitVector<T, Allocator, allocPolicy> operator^(const BitVector<T, Allocator, allocPolicy>& a, const BitVector<T, Allocator2, allocPolicy2>& b)
+{
+    BitVector<T, Allocator, allocPolicy> result(a);
+    result ^= b;
+    return result;
+}
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy>
+BitVector<T, Allocator, allocPolicy> operator~(const BitVector<T, Allocator, allocPolicy>& a)
+{
+    BitVector<T, Allocator, allocPolicy> result(a);
+    result.flip();
+    return result;
+}
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy>
+BitVector<T, Allocator, allocPolicy> operator<<(const BitVector<T, Allocator, allocPolicy>& a, size_t n)
+{
+    BitVector<T, Allocator, allocPolicy> result(a);
+    result <<= n;
+    return result;
+}
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy>
+BitVector<T, Allocator, allocPolicy> operator>>(const BitVector<T, Allocator, allocPolicy>& a, size_t n)
+{
+    BitVector<T, Allocator, allocPolicy> result(a);
+    result >>= n;
+    return result;
+}
+    
+    
 template<class T, size_t N>
 using StaticBitVector = BitVector<T, FixedSizeAllocator<T, (N + BitBlock<T>::BITS_IN_BLOCK - 1)/BitBlock<T>::BITS_IN_BLOCK>, allocationPolicyFixed>;
 
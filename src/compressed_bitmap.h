@@ -0,0 +1,1099 @@
+#ifndef ASTL_COMPRESSED_BITMAP_H
+#define ASTL_COMPRESSED_BITMAP_H
+
+#include "vector.h"
+#include "bitvector.h"
+
+//host only, the 8KB chunk bitmaps and 2^16 bit chunk positions do not fit AVR's memory or its 16 bit size_t
+#if !defined(ARDUINO)
+namespace astl
+{
+
+namespace aux
+{
+struct BitmapRun
+{
+    uint16_t start;
+    uint16_t last;//inclusive, so one run can cover a whole chunk
+};
+
+inline void storeLittleEndian(uint8_t* ptr, uint64_t x, size_t n_bytes)
+{
+    for (size_t i = 0; i < n_bytes; i++)
+    {
+        ptr[i] = static_cast<uint8_t>(x >> (8 * i));
+    }
+}
+
+inline uint64_t loadLittleEndian(const uint8_t* ptr, size_t n_bytes)
+{
+    uint64_t x = 0;
+    for (size_t i = 0; i < n_bytes; i++)
+    {
+        x |= static_cast<uint64_t>(ptr[i]) << (8 * i);
+    }
+    return x;
+}
+}
+
+
+//set of 32 bit integers split in 2^16 value chunks, each kept as a sorted array, a dense bitmap or a list of runs,
+//whichever is smallest (Roaring, Lemire et al.)
+class CompressedBitmap
+{
+public:
+    static const uint32_t CHUNK_BITS = 65536;
+    static const uint32_t ARRAY_MAX = 4096;//past this a uint16_t array is larger than the 8KB bitmap
+
+    typedef Vector<uint16_t> ChunkArray;
+    typedef StaticBitVector<uint64_t, CHUNK_BITS> ChunkBitmap;
+    typedef Vector<aux::BitmapRun> ChunkRuns;
+
+private:
+    static const uint8_t ARRAY_CHUNK = 0;
+    static const uint8_t BITMAP_CHUNK = 1;
+    static const uint8_t RUN_CHUNK = 2;
+
+    static const uint8_t OP_AND = 0;
+    static const uint8_t OP_OR = 1;
+    static const uint8_t OP_AND_NOT = 2;
+
+    static const size_t BITMAP_WORDS = CHUNK_BITS / 64;
+
+    //plain data so the chunk vector can move it around, the payload is owned by the bitmap
+    struct Chunk
+    {
+        void* payload;
+        uint32_t cardinality;
+        uint16_t key;
+        uint8_t type;
+    };
+
+    Vector<Chunk> chunks_;
+
+    static ChunkArray& array(const Chunk& c) {return *static_cast<ChunkArray*>(c.payload);};
+    static ChunkBitmap& bitmap(const Chunk& c) {return *static_cast<ChunkBitmap*>(c.payload);};
+    static ChunkRuns& runs(const Chunk& c) {return *static_cast<ChunkRuns*>(c.payload);};
+
+    static Chunk makeChunk(uint16_t key, uint8_t type)
+    {
+        Chunk c;
+        c.key = key;
+        c.type = type;
+        c.cardinality = 0;
+        if (type == ARRAY_CHUNK)
+        {
+            c.payload = new ChunkArray();
+        }
+        else if (type == BITMAP_CHUNK)
+        {
+            c.payload = new ChunkBitmap(CHUNK_BITS);
+        }
+        else
+        {
+            c.payload = new ChunkRuns();
+        }
+        return c;
+    }
+
+    static void destroy(Chunk& c)
+    {
+        if (c.type == ARRAY_CHUNK)
+        {
+            delete &array(c);
+        }
+        else if (c.type == BITMAP_CHUNK)
+        {
+            delete &bitmap(c);
+        }
+        else
+        {
+            delete &runs(c);
+        }
+        c.payload = nullptr;
+    }
+
+    static Chunk copyChunk(const Chunk& c)
+    {
+        Chunk copy = c;
+        if (c.type == ARRAY_CHUNK)
+        {
+            copy.payload = new ChunkArray(array(c));
+        }
+        else if (c.type == BITMAP_CHUNK)
+        {
+            copy.payload = new ChunkBitmap(bitmap(c));
+        }
+        else
+        {
+            copy.payload = new ChunkRuns(runs(c));
+        }
+        return copy;
+    }
+
+    static void setBit(uint64_t* words, uint32_t i) {words[i >> 6] |= static_cast<uint64_t>(1) << (i & 63);};
+    static void clearBit(uint64_t* words, uint32_t i) {words[i >> 6] &= ~(static_cast<uint64_t>(1) << (i & 63));};
+    static bool testBit(const uint64_t* words, uint32_t i) {return (words[i >> 6] >> (i & 63)) & 1;};
+
+    static void setRange(uint64_t* words, uint32_t first, uint32_t last)
+    {
+        uint32_t first_word = first >> 6;
+        uint32_t last_word = last >> 6;
+        uint64_t first_mask = ~static_cast<uint64_t>(0) << (first & 63);
+        uint64_t last_mask = ~static_cast<uint64_t>(0) >> (63 - (last & 63));
+        if (first_word == last_word)
+        {
+            words[first_word] |= first_mask & last_mask;
+            return;
+        }
+        words[first_word] |= first_mask;
+        for (uint32_t w = first_word + 1; w < last_word; w++)
+        {
+            words[w] = ~static_cast<uint64_t>(0);
+        }
+        words[last_word] |= last_mask;
+    }
+
+    //first position in a sorted array not smaller than x
+    static size_t lowerBound(const ChunkArray& a, uint16_t x)
+    {
+        size_t lo = 0;
+        size_t hi = a.size();
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (a[mid] < x)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    static bool runsContain(const ChunkRuns& r, uint16_t x)
+    {
+        size_t lo = 0;
+        size_t hi = r.size();
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (r[mid].last < x)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo < r.size() && r[lo].start <= x;
+    }
+
+    static size_t countRuns(const Chunk& c)
+    {
+        if (c.type == RUN_CHUNK)
+        {
+            return runs(c).size();
+        }
+        if (c.type == ARRAY_CHUNK)
+        {
+            const ChunkArray& a = array(c);
+            size_t n_runs = a.size() == 0 ? 0 : 1;
+            for (size_t i = 1; i < a.size(); i++)
+            {
+                n_runs += a[i] != a[i - 1] + 1;
+            }
+            return n_runs;
+        }
+        //a run starts at every set bit whose lower neighbour is clear
+        const uint64_t* words = bitmap(c).data();
+        size_t n_runs = 0;
+        uint64_t carry = 0;
+        for (size_t w = 0; w < BITMAP_WORDS; w++)
+        {
+            n_runs += aux::popcount(words[w] & ~((words[w] << 1) | carry));
+            carry = words[w] >> 63;
+        }
+        return n_runs;
+    }
+
+    static Chunk toArray(const Chunk& c)
+    {
+        if (c.type == ARRAY_CHUNK)
+        {
+            return copyChunk(c);
+        }
+        Chunk result = makeChunk(c.key, ARRAY_CHUNK);
+        ChunkArray& a = array(result);
+        a.reserve(c.cardinality);
+        if (c.type == BITMAP_CHUNK)
+        {
+            bitmap(c).forEachSetBit([&a](size_t pos){a.pushBack(static_cast<uint16_t>(pos));});
+        }
+        else
+        {
+            const ChunkRuns& r = runs(c);
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                for (uint32_t x = r[i].start; x <= r[i].last; x++)
+                {
+                    a.pushBack(static_cast<uint16_t>(x));
+                }
+            }
+        }
+        result.cardinality = c.cardinality;
+        return result;
+    }
+
+    static Chunk toBitmap(const Chunk& c)
+    {
+        if (c.type == BITMAP_CHUNK)
+        {
+            return copyChunk(c);
+        }
+        Chunk result = makeChunk(c.key, BITMAP_CHUNK);
+        uint64_t* words = bitmap(result).data();
+        if (c.type == ARRAY_CHUNK)
+        {
+            const ChunkArray& a = array(c);
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                setBit(words, a[i]);
+            }
+        }
+        else
+        {
+            const ChunkRuns& r = runs(c);
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                setRange(words, r[i].start, r[i].last);
+            }
+        }
+        result.cardinality = c.cardinality;
+        return result;
+    }
+
+    static Chunk toRuns(const Chunk& c)
+    {
+        if (c.type == RUN_CHUNK)
+        {
+            return copyChunk(c);
+        }
+        Chunk result = makeChunk(c.key, RUN_CHUNK);
+        ChunkRuns& r = runs(result);
+        aux::BitmapRun run;
+        if (c.type == ARRAY_CHUNK)
+        {
+            const ChunkArray& a = array(c);
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                if (i == 0 || a[i] != a[i - 1] + 1)
+                {
+                    if (i != 0)
+                    {
+                        r.pushBack(run);
+                    }
+                    run.start = a[i];
+                }
+                run.last = a[i];
+            }
+            if (a.size() != 0)
+            {
+                r.pushBack(run);
+            }
+        }
+        else
+        {
+            const ChunkBitmap& b = bitmap(c);
+            for (size_t pos = b.findFirstSet(); pos < CHUNK_BITS; )
+            {
+                size_t end = b.findNextClear(pos);
+                run.start = static_cast<uint16_t>(pos);
+                run.last = static_cast<uint16_t>(end - 1);
+                r.pushBack(run);
+                pos = end < CHUNK_BITS ? b.findNextSet(end) : CHUNK_BITS;
+            }
+        }
+        result.cardinality = c.cardinality;
+        return result;
+    }
+
+    //switches c to its smallest representation
+    static void normalize(Chunk& c)
+    {
+        size_t run_bytes = countRuns(c) * sizeof(aux::BitmapRun);
+        size_t array_bytes = c.cardinality * sizeof(uint16_t);
+        size_t bitmap_bytes = CHUNK_BITS / 8;
+        uint8_t best = c.cardinality <= ARRAY_MAX ? ARRAY_CHUNK : BITMAP_CHUNK;
+        if (run_bytes < (array_bytes < bitmap_bytes ? array_bytes : bitmap_bytes))
+        {
+            best = RUN_CHUNK;
+        }
+        if (best == c.type)
+        {
+            return;
+        }
+        Chunk converted = best == ARRAY_CHUNK ? toArray(c) : (best == BITMAP_CHUNK ? toBitmap(c) : toRuns(c));
+        destroy(c);
+        c = converted;
+    }
+
+    //run chunks are expanded before they are edited or combined with a bitmap
+    static Chunk expanded(const Chunk& c)
+    {
+        return c.cardinality <= ARRAY_MAX ? toArray(c) : toBitmap(c);
+    }
+
+    static Chunk combineArrays(const Chunk& a, const Chunk& b, uint8_t op)
+    {
+        Chunk result = makeChunk(a.key, ARRAY_CHUNK);
+        const ChunkArray& x = array(a);
+        const ChunkArray& y = array(b);
+        ChunkArray& out = array(result);
+        out.reserve(op == OP_OR ? x.size() + y.size() : x.size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < x.size() && j < y.size())
+        {
+            if (x[i] < y[j])
+            {
+                if (op != OP_AND)
+                {
+                    out.pushBack(x[i]);
+                }
+                i++;
+            }
+            else if (y[j] < x[i])
+            {
+                if (op == OP_OR)
+                {
+                    out.pushBack(y[j]);
+                }
+                j++;
+            }
+            else
+            {
+                if (op != OP_AND_NOT)
+                {
+                    out.pushBack(x[i]);
+                }
+                i++;
+                j++;
+            }
+        }
+        for (; op != OP_AND && i < x.size(); i++)
+        {
+            out.pushBack(x[i]);
+        }
+        for (; op == OP_OR && j < y.size(); j++)
+        {
+            out.pushBack(y[j]);
+        }
+        result.cardinality = out.size();
+        return result;
+    }
+
+    //keeps the array values that are (or with keep_set false, are not) in the bitmap
+    static Chunk filterArray(const Chunk& a, const Chunk& b, bool keep_set)
+    {
+        Chunk result = makeChunk(a.key, ARRAY_CHUNK);
+        const ChunkArray& x = array(a);
+        const uint64_t* words = bitmap(b).data();
+        ChunkArray& out = array(result);
+        out.reserve(x.size());
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            if (testBit(words, x[i]) == keep_set)
+            {
+                out.pushBack(x[i]);
+            }
+        }
+        result.cardinality = out.size();
+        return result;
+    }
+
+    static Chunk combineExpanded(const Chunk& a, const Chunk& b, uint8_t op)
+    {
+        if (a.type == ARRAY_CHUNK && b.type == ARRAY_CHUNK)
+        {
+            return combineArrays(a, b, op);
+        }
+        if (op == OP_AND && a.type == ARRAY_CHUNK)
+        {
+            return filterArray(a, b, true);
+        }
+        if (op == OP_AND && b.type == ARRAY_CHUNK)
+        {
+            return filterArray(b, a, true);
+        }
+        if (op == OP_AND_NOT && a.type == ARRAY_CHUNK)
+        {
+            return filterArray(a, b, false);
+        }
+
+        Chunk result = op == OP_OR && a.type == ARRAY_CHUNK ? toBitmap(b) : toBitmap(a);
+        const Chunk& other = op == OP_OR && a.type == ARRAY_CHUNK ? a : b;
+        ChunkBitmap& out = bitmap(result);
+        if (other.type == ARRAY_CHUNK)
+        {
+            const ChunkArray& y = array(other);
+            uint64_t* words = out.data();
+            for (size_t i = 0; i < y.size(); i++)
+            {
+                if (op == OP_OR)
+                {
+                    setBit(words, y[i]);
+                }
+                else
+                {
+                    clearBit(words, y[i]);
+                }
+            }
+        }
+        else if (op == OP_AND)
+        {
+            out &= bitmap(other);
+        }
+        else if (op == OP_OR)
+        {
+            out |= bitmap(other);
+        }
+        else
+        {
+            out.andNot(bitmap(other));
+        }
+        result.cardinality = out.count();
+        return result;
+    }
+
+    //an array is read as runs of one value
+    static size_t runCount(const Chunk& c)
+    {
+        return c.type == RUN_CHUNK ? runs(c).size() : array(c).size();
+    }
+
+    static aux::BitmapRun runAt(const Chunk& c, size_t i)
+    {
+        if (c.type == RUN_CHUNK)
+        {
+            return runs(c)[i];
+        }
+        aux::BitmapRun run;
+        run.start = array(c)[i];
+        run.last = run.start;
+        return run;
+    }
+
+    //appends [start, last] merging it into the previous run when they touch or overlap
+    static void appendRun(ChunkRuns& out, uint32_t start, uint32_t last)
+    {
+        if (out.size() != 0 && start <= static_cast<uint32_t>(out[out.size() - 1].last) + 1)
+        {
+            aux::BitmapRun& previous = out[out.size() - 1];
+            if (last > previous.last)
+            {
+                previous.last = static_cast<uint16_t>(last);
+            }
+            return;
+        }
+        aux::BitmapRun run;
+        run.start = static_cast<uint16_t>(start);
+        run.last = static_cast<uint16_t>(last);
+        out.pushBack(run);
+    }
+
+    //run/run and run/array operations as one sweep over the sorted intervals of both sides, nothing is expanded
+    static Chunk combineRuns(const Chunk& a, const Chunk& b, uint8_t op)
+    {
+        Chunk result = makeChunk(a.key, RUN_CHUNK);
+        ChunkRuns& out = runs(result);
+        const size_t n_a = runCount(a);
+        const size_t n_b = runCount(b);
+        size_t i = 0;
+        size_t j = 0;
+        if (op == OP_OR)
+        {
+            while (i < n_a || j < n_b)
+            {
+                aux::BitmapRun run = j == n_b || (i < n_a && runAt(a, i).start < runAt(b, j).start) ? runAt(a, i++) : runAt(b, j++);
+                appendRun(out, run.start, run.last);
+            }
+        }
+        else if (op == OP_AND)
+        {
+            while (i < n_a && j < n_b)
+            {
+                aux::BitmapRun x = runAt(a, i);
+                aux::BitmapRun y = runAt(b, j);
+                uint16_t start = x.start > y.start ? x.start : y.start;
+                uint16_t last = x.last < y.last ? x.last : y.last;
+                if (start <= last)
+                {
+                    appendRun(out, start, last);
+                }
+                if (x.last < y.last)
+                {
+                    i++;
+                }
+                else
+                {
+                    j++;
+                }
+            }
+        }
+        else
+        {
+            for (; i < n_a; i++)
+            {
+                aux::BitmapRun x = runAt(a, i);
+                uint32_t next = x.start;
+                while (j < n_b && runAt(b, j).last < next)
+                {
+                    j++;
+                }
+                for (size_t k = j; k < n_b && runAt(b, k).start <= x.last && next <= x.last; k++)
+                {
+                    aux::BitmapRun y = runAt(b, k);
+                    if (y.start > next)
+                    {
+                        appendRun(out, next, y.start - 1u);
+                    }
+                    next = static_cast<uint32_t>(y.last) + 1;
+                }
+                if (next <= x.last)
+                {
+                    appendRun(out, next, x.last);
+                }
+            }
+        }
+        for (size_t k = 0; k < out.size(); k++)
+        {
+            result.cardinality += static_cast<uint32_t>(out[k].last) - out[k].start + 1;
+        }
+        return result;
+    }
+
+    static Chunk combine(const Chunk& a, const Chunk& b, uint8_t op)
+    {
+        Chunk result;
+        if ((a.type == RUN_CHUNK && b.type != BITMAP_CHUNK) || (b.type == RUN_CHUNK && a.type != BITMAP_CHUNK))
+        {
+            result = combineRuns(a, b, op);
+        }
+        else if (a.type == RUN_CHUNK || b.type == RUN_CHUNK)
+        {
+            Chunk x = a.type == RUN_CHUNK ? expanded(a) : a;
+            Chunk y = b.type == RUN_CHUNK ? expanded(b) : b;
+            result = combineExpanded(x, y, op);
+            if (a.type == RUN_CHUNK)
+            {
+                destroy(x);
+            }
+            if (b.type == RUN_CHUNK)
+            {
+                destroy(y);
+            }
+        }
+        else
+        {
+            result = combineExpanded(a, b, op);
+        }
+        if (result.cardinality != 0)
+        {
+            normalize(result);
+        }
+        return result;
+    }
+
+    //merges the chunk lists key by key, chunks only in x are copied when op is OR
+    CompressedBitmap& combineWith(const CompressedBitmap& x, uint8_t op)
+    {
+        Vector<Chunk> result;
+        result.reserve(op == OP_OR ? chunks_.size() + x.chunks_.size() : chunks_.size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < chunks_.size() || j < x.chunks_.size())
+        {
+            if (j == x.chunks_.size() || (i < chunks_.size() && chunks_[i].key < x.chunks_[j].key))
+            {
+                if (op == OP_AND)
+                {
+                    destroy(chunks_[i]);
+                }
+                else
+                {
+                    result.pushBack(chunks_[i]);
+                }
+                i++;
+            }
+            else if (i == chunks_.size() || x.chunks_[j].key < chunks_[i].key)
+            {
+                if (op == OP_OR)
+                {
+                    result.pushBack(copyChunk(x.chunks_[j]));
+                }
+                j++;
+            }
+            else
+            {
+                Chunk c = combine(chunks_[i], x.chunks_[j], op);
+                if (c.cardinality == 0)
+                {
+                    destroy(c);
+                }
+                else
+                {
+                    result.pushBack(c);
+                }
+                if (this != &x)
+                {
+                    destroy(chunks_[i]);
+                }
+                i++;
+                j++;
+            }
+        }
+        if (this == &x)
+        {//every chunk was read through x as well, so they go only once all are combined
+            for (size_t k = 0; k < chunks_.size(); k++)
+            {
+                destroy(chunks_[k]);
+            }
+        }
+        chunks_ = std::move(result);
+        return *this;
+    }
+
+    size_t findChunk(uint16_t key) const
+    {
+        size_t lo = 0;
+        size_t hi = chunks_.size();
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (chunks_[mid].key < key)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    static bool chunkContains(const Chunk& c, uint16_t low)
+    {
+        if (c.type == ARRAY_CHUNK)
+        {
+            size_t pos = lowerBound(array(c), low);
+            return pos < array(c).size() && array(c)[pos] == low;
+        }
+        if (c.type == BITMAP_CHUNK)
+        {
+            return testBit(bitmap(c).data(), low);
+        }
+        return runsContain(runs(c), low);
+    }
+
+    void clearChunks()
+    {
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            destroy(chunks_[i]);
+        }
+        chunks_.clear();
+    }
+
+public:
+    bool empty() const {return chunks_.size() == 0;};
+
+    size_t cardinality() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            n += chunks_[i].cardinality;
+        }
+        return n;
+    }
+
+    //payload bytes plus the chunk index
+    size_t sizeBytes() const
+    {
+        size_t n = chunks_.size() * sizeof(Chunk);
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            const Chunk& c = chunks_[i];
+            n += c.type == ARRAY_CHUNK ? array(c).size() * sizeof(uint16_t) :
+                (c.type == BITMAP_CHUNK ? CHUNK_BITS / 8 : runs(c).size() * sizeof(aux::BitmapRun));
+        }
+        return n;
+    }
+
+    bool contains(uint32_t x) const
+    {
+        size_t i = findChunk(static_cast<uint16_t>(x >> 16));
+        return i < chunks_.size() && chunks_[i].key == (x >> 16) && chunkContains(chunks_[i], static_cast<uint16_t>(x));
+    }
+
+    //returns false only when memory ran out
+    bool add(uint32_t x)
+    {
+        uint16_t key = static_cast<uint16_t>(x >> 16);
+        uint16_t low = static_cast<uint16_t>(x);
+        size_t i = findChunk(key);
+        if (i == chunks_.size() || chunks_[i].key != key)
+        {
+            Chunk fresh = makeChunk(key, ARRAY_CHUNK);
+            if (!chunks_.insert(i, fresh))
+            {
+                destroy(fresh);
+                return false;
+            }
+        }
+        Chunk& c = chunks_[i];
+        if (chunkContains(c, low))
+        {
+            return true;
+        }
+        if (c.type == RUN_CHUNK)
+        {
+            Chunk e = expanded(c);
+            destroy(c);
+            c = e;
+        }
+        if (c.type == ARRAY_CHUNK)
+        {
+            ChunkArray& a = array(c);
+            if (a.size() == ARRAY_MAX)
+            {
+                Chunk b = toBitmap(c);
+                destroy(c);
+                c = b;
+            }
+            else if (!a.insert(lowerBound(a, low), low))
+            {
+                return false;
+            }
+        }
+        if (c.type == BITMAP_CHUNK)
+        {
+            setBit(bitmap(c).data(), low);
+        }
+        c.cardinality++;
+        return true;
+    }
+
+    //returns true when x was in the set
+    bool remove(uint32_t x)
+    {
+        uint16_t key = static_cast<uint16_t>(x >> 16);
+        uint16_t low = static_cast<uint16_t>(x);
+        size_t i = findChunk(key);
+        if (i == chunks_.size() || chunks_[i].key != key || !chunkContains(chunks_[i], low))
+        {
+            return false;
+        }
+        Chunk& c = chunks_[i];
+        if (c.type == RUN_CHUNK)
+        {
+            Chunk e = expanded(c);
+            destroy(c);
+            c = e;
+        }
+        c.cardinality--;
+        if (c.cardinality == 0)
+        {
+            destroy(c);
+            chunks_.erase(i);
+            return true;
+        }
+        if (c.type == ARRAY_CHUNK)
+        {
+            array(c).erase(lowerBound(array(c), low));
+        }
+        else
+        {
+            clearBit(bitmap(c).data(), low);
+            if (c.cardinality <= ARRAY_MAX)
+            {
+                Chunk a = toArray(c);
+                destroy(c);
+                c = a;
+            }
+        }
+        return true;
+    }
+
+    void clear()
+    {
+        clearChunks();
+    }
+
+    //moves every chunk to its smallest representation, including runs
+    void optimize()
+    {
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            normalize(chunks_[i]);
+        }
+    }
+
+    //calls f(x) for every value in increasing order
+    template<class Function>
+    void forEach(Function f) const
+    {
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            const Chunk& c = chunks_[i];
+            uint32_t base = static_cast<uint32_t>(c.key) << 16;
+            if (c.type == ARRAY_CHUNK)
+            {
+                const ChunkArray& a = array(c);
+                for (size_t k = 0; k < a.size(); k++)
+                {
+                    f(base | a[k]);
+                }
+            }
+            else if (c.type == BITMAP_CHUNK)
+            {
+                bitmap(c).forEachSetBit([&f, base](size_t pos){f(base | static_cast<uint32_t>(pos));});
+            }
+            else
+            {
+                const ChunkRuns& r = runs(c);
+                for (size_t k = 0; k < r.size(); k++)
+                {
+                    for (uint32_t x = r[k].start; x <= r[k].last; x++)
+                    {
+                        f(base | x);
+                    }
+                }
+            }
+        }
+    }
+
+
+    CompressedBitmap& operator|=(const CompressedBitmap& x) {return combineWith(x, OP_OR);};
+    CompressedBitmap& operator&=(const CompressedBitmap& x) {return combineWith(x, OP_AND);};
+    CompressedBitmap& operator-=(const CompressedBitmap& x) {return combineWith(x, OP_AND_NOT);};
+
+
+    //serialized format, all little endian: uint32 chunk count, then per chunk uint16 key, uint8 type (0 array,
+    //1 bitmap, 2 runs), uint32 count (values for arrays and bitmaps, runs for run chunks) and the payload:
+    //count uint16 values, 1024 uint64 words or count (uint16 start, uint16 inclusive last) pairs
+    size_t serializedBytes() const
+    {
+        size_t n = 4;
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            const Chunk& c = chunks_[i];
+            n += 7;
+            n += c.type == ARRAY_CHUNK ? 2 * c.cardinality : (c.type == BITMAP_CHUNK ? CHUNK_BITS / 8 : 4 * runs(c).size());
+        }
+        return n;
+    }
+
+    //returns the number of bytes written, 0 when the buffer is too small
+    size_t serialize(uint8_t* buffer, size_t n_bytes) const
+    {
+        size_t total = serializedBytes();
+        if (n_bytes < total)
+        {
+            return 0;
+        }
+        uint8_t* ptr = buffer;
+        aux::storeLittleEndian(ptr, chunks_.size(), 4);
+        ptr += 4;
+        for (size_t i = 0; i < chunks_.size(); i++)
+        {
+            const Chunk& c = chunks_[i];
+            aux::storeLittleEndian(ptr, c.key, 2);
+            ptr[2] = c.type;
+            aux::storeLittleEndian(ptr + 3, c.type == RUN_CHUNK ? runs(c).size() : c.cardinality, 4);
+            ptr += 7;
+            if (c.type == ARRAY_CHUNK)
+            {
+                const ChunkArray& a = array(c);
+                for (size_t k = 0; k < a.size(); k++, ptr += 2)
+                {
+                    aux::storeLittleEndian(ptr, a[k], 2);
+                }
+            }
+            else if (c.type == BITMAP_CHUNK)
+            {
+                const uint64_t* words = bitmap(c).data();
+                for (size_t k = 0; k < BITMAP_WORDS; k++, ptr += 8)
+                {
+                    aux::storeLittleEndian(ptr, words[k], 8);
+                }
+            }
+            else
+            {
+                const ChunkRuns& r = runs(c);
+                for (size_t k = 0; k < r.size(); k++, ptr += 4)
+                {
+                    aux::storeLittleEndian(ptr, r[k].start, 2);
+                    aux::storeLittleEndian(ptr + 2, r[k].last, 2);
+                }
+            }
+        }
+        return total;
+    }
+
+    //replaces the content, returns false and leaves the bitmap empty on malformed input
+    bool deserialize(const uint8_t* buffer, size_t n_bytes)
+    {
+        clearChunks();
+        const uint8_t* end = buffer + n_bytes;
+        if (n_bytes < 4)
+        {
+            return false;
+        }
+        size_t n_chunks = aux::loadLittleEndian(buffer, 4);
+        const uint8_t* ptr = buffer + 4;
+        for (size_t i = 0; i < n_chunks; i++)
+        {
+            if (end - ptr < 7)
+            {
+                clearChunks();
+                return false;
+            }
+            uint16_t key = static_cast<uint16_t>(aux::loadLittleEndian(ptr, 2));
+            uint8_t type = ptr[2];
+            size_t count = aux::loadLittleEndian(ptr + 3, 4);
+            ptr += 7;
+            size_t payload = type == ARRAY_CHUNK ? 2 * count : (type == BITMAP_CHUNK ? CHUNK_BITS / 8 : 4 * count);
+            bool valid = type <= RUN_CHUNK && count != 0 && count <= CHUNK_BITS && static_cast<size_t>(end - ptr) >= payload &&
+                (chunks_.size() == 0 || chunks_.back().key < key);
+            if (!valid)
+            {
+                clearChunks();
+                return false;
+            }
+
+            Chunk c = makeChunk(key, type);
+            if (type == ARRAY_CHUNK)
+            {
+                ChunkArray& a = array(c);
+                a.reserve(count);
+                for (size_t k = 0; k < count && valid; k++, ptr += 2)
+                {
+                    uint16_t x = static_cast<uint16_t>(aux::loadLittleEndian(ptr, 2));
+                    valid = k == 0 || a.back() < x;
+                    a.pushBack(x);
+                }
+                c.cardinality = count;
+            }
+            else if (type == BITMAP_CHUNK)
+            {
+                uint64_t* words = bitmap(c).data();
+                for (size_t k = 0; k < BITMAP_WORDS; k++, ptr += 8)
+                {
+                    words[k] = aux::loadLittleEndian(ptr, 8);
+                }
+                c.cardinality = bitmap(c).count();
+                valid = c.cardinality == count;
+            }
+            else
+            {
+                ChunkRuns& r = runs(c);
+                r.reserve(count);
+                for (size_t k = 0; k < count && valid; k++, ptr += 4)
+                {
+                    aux::BitmapRun run;
+                    run.start = static_cast<uint16_t>(aux::loadLittleEndian(ptr, 2));
+                    run.last = static_cast<uint16_t>(aux::loadLittleEndian(ptr + 2, 2));
+                    valid = run.start <= run.last && (k == 0 || static_cast<uint32_t>(r.back().last) + 1 < run.start);
+                    r.pushBack(run);
+                    c.cardinality += run.last - run.start + 1;
+                }
+            }
+            if (!valid || !chunks_.pushBack(c))
+            {
+                destroy(c);
+                clearChunks();
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    CompressedBitmap() {};
+
+    CompressedBitmap(const CompressedBitmap& x)
+    {
+        chunks_.reserve(x.chunks_.size());
+        for (size_t i = 0; i < x.chunks_.size(); i++)
+        {
+            chunks_.pushBack(copyChunk(x.chunks_[i]));
+        }
+    }
+
+    CompressedBitmap(CompressedBitmap&& x)
+        :chunks_(std::move(x.chunks_)) {};
+
+    CompressedBitmap& operator=(const CompressedBitmap& x)
+    {
+        if (this != &x)
+        {
+            clearChunks();
+            chunks_.reserve(x.chunks_.size());
+            for (size_t i = 0; i < x.chunks_.size(); i++)
+            {
+                chunks_.pushBack(copyChunk(x.chunks_[i]));
+            }
+        }
+        return *this;
+    }
+
+    CompressedBitmap& operator=(CompressedBitmap&& x)
+    {
+        if (this != &x)
+        {
+            clearChunks();
+            chunks_ = std::move(x.chunks_);
+        }
+        return *this;
+    }
+
+    ~CompressedBitmap()
+    {
+        clearChunks();
+    }
+};
+
+
+inline CompressedBitmap operator|(const CompressedBitmap& a, const CompressedBitmap& b)
+{
+    CompressedBitmap result(a);
+    result |= b;
+    return result;
+}
+
+inline CompressedBitmap operator&(const CompressedBitmap& a, const CompressedBitmap& b)
+{
+    CompressedBitmap result(a);
+    result &= b;
+    return result;
+}
+
+inline CompressedBitmap operator-(const CompressedBitmap& a, const CompressedBitmap& b)
+{
+    CompressedBitmap result(a);
+    result -= b;
+    return result;
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,477 @@
+#ifndef ASTL_DEQUE_H
+#define ASTL_DEQUE_H
+
+#include "allocator.h"
+#include "initializer_list.h"
+
+namespace astl
+{
+
+namespace aux
+{
+#if defined(ARDUINO)
+static const size_t DEQUE_BLOCK_BYTES = 32;
+#else
+static const size_t DEQUE_BLOCK_BYTES = 512;
+#endif
+
+constexpr size_t floorPowerOfTwo(size_t n, size_t p = 1)
+{
+    return p * 2 > n ? p : floorPowerOfTwo(n, p * 2);
+}
+
+//rounded down to a power of two so that locating an element is a shift and a mask
+template<class T>
+struct DequeBlockSize
+{
+    static const size_t value = sizeof(T) < DEQUE_BLOCK_BYTES ? floorPowerOfTwo(DEQUE_BLOCK_BYTES / sizeof(T)) : 1;
+};
+
+//allocators that return the same buffer for every call can not back more than one block
+template<class Allocator>
+struct IsSingleBufferAllocator
+{
+    static const bool value = false;
+};
+
+template<class T, size_t N>
+struct IsSingleBufferAllocator<FixedSizeAllocator<T, N>>
+{
+    static const bool value = true;
+};
+}
+
+
+template<class Container, class T>
+class DequeIterator
+{
+    Container* container_;
+    size_t pos_;
+
+public:
+    T& operator*() const {return (*container_)[pos_];};
+    T* operator->() const {return &(*container_)[pos_];};
+
+    DequeIterator& operator++() {pos_++; return *this;};
+    DequeIterator operator++(int) {DequeIterator old = *this; pos_++; return old;};
+    DequeIterator& operator--() {pos_--; return *this;};
+    DequeIterator operator--(int) {DequeIterator old = *this; pos_--; return old;};
+
+    bool operator==(const DequeIterator& it) const {return pos_ == it.pos_ && container_ == it.container_;};
+    bool operator!=(const DequeIterator& it) const {return !((*this) == it);};
+
+    DequeIterator(Container* container, size_t pos)
+        :container_(container), pos_(pos) {};
+};
+
+
+//elements live in fixed size blocks, a circular map of block pointers grows at either end, one emptied block is kept
+//at each end so that pushes and pops alternating across a block boundary do not allocate every time. Each block is a
+//separate allocation, StaticDeque is the fixed buffer version
+template<class T, class Allocator = HeapAllocator<T>, size_t BlockSize = aux::DequeBlockSize<T>::value>
+class Deque
+{
+    static_assert(!aux::IsSingleBufferAllocator<Allocator>::value, "Deque needs one allocation per block, use StaticDeque");
+
+    T** map_;
+    HeapAllocator<T*> map_allocator_;
+    size_t map_capacity_;
+    size_t map_head_;
+    size_t n_blocks_;
+    size_t start_;//offset of the first element inside the first block
+    size_t size_;
+    Allocator allocator_;
+
+    T*& block(size_t i) {return map_[(map_head_ + i) & (map_capacity_ - 1)];};
+    T* const& block(size_t i) const {return map_[(map_head_ + i) & (map_capacity_ - 1)];};
+
+    T* slot(size_t i)
+    {
+        size_t pos = start_ + i;
+        return block(pos / BlockSize) + pos % BlockSize;
+    }
+
+    const T* slot(size_t i) const
+    {
+        size_t pos = start_ + i;
+        return block(pos / BlockSize) + pos % BlockSize;
+    }
+
+    bool reserveMap(size_t n_blocks)
+    {
+        if (n_blocks <= map_capacity_)
+        {
+            return true;
+        }
+        size_t new_capacity = map_capacity_ == 0 ? 4 : map_capacity_ * 2;
+        while (new_capacity < n_blocks)
+        {
+            new_capacity = new_capacity * 2;
+        }
+        T** new_map = map_allocator_.allocate(new_capacity);
+        if (new_map == nullptr)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < n_blocks_; i++)
+        {
+            new_map[i] = block(i);
+        }
+        map_allocator_.deallocate(map_, map_capacity_);
+        map_ = new_map;
+        map_capacity_ = new_capacity;
+        map_head_ = 0;
+        return true;
+    }
+
+    bool addBackBlock()
+    {
+        if (!reserveMap(n_blocks_ + 1))
+        {
+            return false;
+        }
+        T* new_block = allocator_.allocate(BlockSize);
+        if (new_block == nullptr)
+        {
+            return false;
+        }
+        n_blocks_++;
+        block(n_blocks_ - 1) = new_block;
+        return true;
+    }
+
+    bool addFrontBlock()
+    {
+        if (!reserveMap(n_blocks_ + 1))
+        {
+            return false;
+        }
+        T* new_block = allocator_.allocate(BlockSize);
+        if (new_block == nullptr)
+        {
+            return false;
+        }
+        map_head_ = (map_head_ + map_capacity_ - 1) & (map_capacity_ - 1);
+        n_blocks_++;
+        block(0) = new_block;
+        start_ += BlockSize;
+        return true;
+    }
+
+    void releaseBackBlock()
+    {
+        allocator_.deallocate(block(n_blocks_ - 1), BlockSize);
+        n_blocks_--;
+    }
+
+    void releaseFrontBlock()
+    {
+        allocator_.deallocate(block(0), BlockSize);
+        map_head_ = (map_head_ + 1) & (map_capacity_ - 1);
+        n_blocks_--;
+        start_ -= BlockSize;
+    }
+
+public:
+    size_t size() const {return size_;};
+    bool empty() const {return size_ == 0;};
+
+    T& operator[](size_t i) {return *slot(i);};
+    const T& operator[](size_t i) const {return *slot(i);};
+
+    T& front() {return *slot(0);};
+    const T& front() const {return *slot(0);};
+    T& back() {return *slot(size_ - 1);};
+    const T& back() const {return *slot(size_ - 1);};
+
+
+    template<class ...Args>
+    bool emplaceBack(Args&&... args)
+    {
+        if (start_ + size_ == n_blocks_ * BlockSize && !addBackBlock())
+        {
+            return false;
+        }
+        new (slot(size_)) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+
+    bool pushBack(const T& x)
+    {
+        return emplaceBack(x);
+    }
+
+
+    template<class ...Args>
+    bool emplaceFront(Args&&... args)
+    {
+        if (start_ == 0 && !addFrontBlock())
+        {
+            return false;
+        }
+        start_--;
+        new (slot(0)) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+
+    bool pushFront(const T& x)
+    {
+        return emplaceFront(x);
+    }
+
+
+    bool popBack()
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        slot(size_ - 1)->~T();
+        size_--;
+        if (start_ + size_ + 2 * BlockSize <= n_blocks_ * BlockSize)
+        {
+            releaseBackBlock();
+        }
+        return true;
+    }
+
+
+    bool popFront()
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        slot(0)->~T();
+        start_++;
+        size_--;
+        if (start_ >= 2 * BlockSize)
+        {
+            releaseFrontBlock();
+        }
+        return true;
+    }
+
+
+    void clear()
+    {
+        for (size_t i = 0; i < size_; i++)
+        {
+            slot(i)->~T();
+        }
+        while (n_blocks_ != 0)
+        {
+            releaseBackBlock();
+        }
+        size_ = 0;
+        start_ = 0;
+        map_head_ = 0;
+    }
+
+
+    typedef DequeIterator<Deque, T> iterator;
+    typedef DequeIterator<const Deque, const T> const_iterator;
+    iterator begin() {return iterator(this, 0);};
+    iterator end() {return iterator(this, size_);};
+    const_iterator begin() const {return const_iterator(this, 0);};
+    const_iterator end() const {return const_iterator(this, size_);};
+
+
+    Deque()
+        :map_(nullptr), map_allocator_(), map_capacity_(0), map_head_(0), n_blocks_(0), start_(0), size_(0), allocator_() {};
+
+    Deque(const Deque& x)
+        :Deque()
+    {
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            pushBack(x[i]);
+        }
+    }
+
+    Deque(std::initializer_list<T> l)
+        :Deque()
+    {
+        for (auto it = l.begin(); it != l.end(); it++)
+        {
+            pushBack(*it);
+        }
+    }
+
+    Deque& operator=(const Deque& x)
+    {
+        if (this != &x)
+        {
+            clear();
+            for (size_t i = 0; i < x.size(); i++)
+            {
+                pushBack(x[i]);
+            }
+        }
+        return *this;
+    }
+
+    ~Deque()
+    {
+        clear();
+        map_allocator_.deallocate(map_, map_capacity_);
+    }
+};
+
+
+//single fixed buffer used as a ring
+template<class T, size_t N>
+class StaticDeque
+{
+    alignas(T) uint8_t data_[N * sizeof(T)];
+    size_t head_;
+    size_t size_;
+
+    T* slot(size_t i)
+    {
+        size_t pos = head_ + i;
+        return reinterpret_cast<T*>(data_) + (pos < N ? pos : pos - N);
+    }
+
+    const T* slot(size_t i) const
+    {
+        size_t pos = head_ + i;
+        return reinterpret_cast<const T*>(data_) + (pos < N ? pos : pos - N);
+    }
+
+public:
+    size_t size() const {return size_;};
+    constexpr size_t capacity() const {return N;};
+    bool empty() const {return size_ == 0;};
+    bool full() const {return size_ == N;};
+
+    T& operator[](size_t i) {return *slot(i);};
+    const T& operator[](size_t i) const {return *slot(i);};
+
+    T& front() {return *slot(0);};
+    const T& front() const {return *slot(0);};
+    T& back() {return *slot(size_ - 1);};
+    const T& back() const {return *slot(size_ - 1);};
+
+
+    template<class ...Args>
+    bool emplaceBack(Args&&... args)
+    {
+        if (size_ == N)
+        {
+            return false;
+        }
+        new (slot(size_)) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+
+    bool pushBack(const T& x)
+    {
+        return emplaceBack(x);
+    }
+
+
+    template<class ...Args>
+    bool emplaceFront(Args&&... args)
+    {
+        if (size_ == N)
+        {
+            return false;
+        }
+        head_ = head_ == 0 ? N - 1 : head_ - 1;
+        new (slot(0)) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+
+    bool pushFront(const T& x)
+    {
+        return emplaceFront(x);
+    }
+
+
+    bool popBack()
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        slot(size_ - 1)->~T();
+        size_--;
+        return true;
+    }
+
+
+    bool popFront()
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        slot(0)->~T();
+        head_ = head_ + 1 == N ? 0 : head_ + 1;
+        size_--;
+        return true;
+    }
+
+
+    void clear()
+    {
+        for (size_t i = 0; i < size_; i++)
+        {
+            slot(i)->~T();
+        }
+        head_ = 0;
+        size_ = 0;
+    }
+
+
+    typedef DequeIterator<StaticDeque, T> iterator;
+    typedef DequeIterator<const StaticDeque, const T> const_iterator;
+    iterator begin() {return iterator(this, 0);};
+    iterator end() {return iterator(this, size_);};
+    const_iterator begin() const {return const_iterator(this, 0);};
+    const_iterator end() const {return const_iterator(this, size_);};
+
+
+    StaticDeque()
+        :head_(0), size_(0) {};
+
+    StaticDeque(const StaticDeque& x)
+        :StaticDeque()
+    {
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            pushBack(x[i]);
+        }
+    }
+
+    StaticDeque& operator=(const StaticDeque& x)
+    {
+        if (this != &x)
+        {
+            clear();
+            for (size_t i = 0; i < x.size(); i++)
+            {
+                pushBack(x[i]);
+            }
+        }
+        return *this;
+    }
+
+    ~StaticDeque()
+    {
+        clear();
+    }
+};
+
+}
+
+#endif
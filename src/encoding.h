@@ -0,0 +1,501 @@
+#ifndef ASTL_ENCODING_H
+#define ASTL_ENCODING_H
+
+#include "bitvector.h"
+
+namespace astl
+{
+
+namespace aux
+{
+static const size_t MAX_VARINT_BYTES = 10;
+
+//integers are encoded through an unsigned word of their own width class, 64 bit arithmetic only when the type needs it
+template<bool Wide>
+struct EncodingWordSelect
+{
+    typedef uint32_t type;
+};
+
+template<>
+struct EncodingWordSelect<true>
+{
+    typedef uint64_t type;
+};
+
+template<class T>
+struct EncodingWord
+{
+    typedef typename EncodingWordSelect<(sizeof(T) > sizeof(uint32_t))>::type type;
+};
+
+//signed values are sign extended into the word, flipping its top bit keeps the order for frame of reference
+template<class T>
+inline typename EncodingWord<T>::type orderedWord(T x)
+{
+    typedef typename EncodingWord<T>::type Word;
+    const Word sign = static_cast<T>(-1) < static_cast<T>(0) ? static_cast<Word>(static_cast<Word>(1) << (sizeof(Word) * 8 - 1)) : 0;
+    return static_cast<Word>(static_cast<Word>(x) ^ sign);
+}
+
+template<class T>
+inline T fromOrderedWord(typename EncodingWord<T>::type x)
+{
+    typedef typename EncodingWord<T>::type Word;
+    const Word sign = static_cast<T>(-1) < static_cast<T>(0) ? static_cast<Word>(static_cast<Word>(1) << (sizeof(Word) * 8 - 1)) : 0;
+    return static_cast<T>(x ^ sign);
+}
+
+//maps the wrapped difference of two words to small numbers for small steps either way: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+template<class Word>
+inline Word zigzagEncode(Word delta)
+{
+    return static_cast<Word>(static_cast<Word>(delta << 1) ^ static_cast<Word>(0 - (delta >> (sizeof(Word) * 8 - 1))));
+}
+
+template<class Word>
+inline Word zigzagDecode(Word x)
+{
+    return static_cast<Word>((x >> 1) ^ static_cast<Word>(0 - (x & 1)));
+}
+
+
+inline size_t varintBytes(uint64_t x)
+{
+    size_t n = 1;
+    while (x >= 0x80)
+    {
+        x = x >> 7;
+        n++;
+    }
+    return n;
+}
+
+//LEB128, 7 bits per byte starting with the lowest, the top bit marks that another byte follows
+inline uint8_t* writeVarint(uint8_t* ptr, uint64_t x)
+{
+    while (x >= 0x80)
+    {
+        *ptr++ = static_cast<uint8_t>(x | 0x80);
+        x = x >> 7;
+    }
+    *ptr++ = static_cast<uint8_t>(x);
+    return ptr;
+}
+
+//returns the byte after the varint, nullptr if it is truncated or longer than MAX_VARINT_BYTES
+inline const uint8_t* readVarint(const uint8_t* ptr, const uint8_t* end, uint64_t& x)
+{
+#if !defined(ARDUINO)
+    //with 8 readable bytes a varint of up to 8 bytes is decoded from one load: the first clear top bit gives its
+    //length and the 7 bit groups are gathered with pext, or with shifts without bmi2
+    if (end - ptr >= 8)
+    {
+        uint64_t word;
+        ::memcpy(&word, ptr, sizeof(uint64_t));
+        uint64_t stops = ~word & 0x8080808080808080ull;
+        if (stops != 0)
+        {
+            size_t n_bytes = countTrailingZeros(stops) / 8 + 1;
+            word = n_bytes == 8 ? word : word & lowBitsMask<uint64_t>(n_bytes * 8);
+#if defined(__BMI2__)
+            x = _pext_u64(word, 0x7F7F7F7F7F7F7F7Full);
+#else
+            x = (word & 0x7Full) | ((word >> 1) & (0x7Full << 7)) | ((word >> 2) & (0x7Full << 14)) | ((word >> 3) & (0x7Full << 21)) |
+                ((word >> 4) & (0x7Full << 28)) | ((word >> 5) & (0x7Full << 35)) | ((word >> 6) & (0x7Full << 42)) | ((word >> 7) & (0x7Full << 49));
+#endif
+            return ptr + n_bytes;
+        }
+    }
+#endif
+    x = 0;
+    for (size_t shift = 0; ptr != end && shift < MAX_VARINT_BYTES * 7; shift += 7)
+    {
+        uint8_t byte = *ptr++;
+        x |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return ptr;
+        }
+    }
+    return nullptr;
+}
+
+
+//appends width bits of x (which must fit them) to a little endian bit stream, whole bytes leave the accumulator
+inline void putBits(uint8_t*& out, uint64_t& acc, size_t& n_acc, uint64_t x, size_t width)
+{
+    if (width > 32)
+    {
+        putBits(out, acc, n_acc, x & 0xFFFFFFFFull, 32);
+        x = x >> 32;
+        width -= 32;
+    }
+    acc |= x << n_acc;
+    n_acc += width;
+    while (n_acc >= 8)
+    {
+        *out++ = static_cast<uint8_t>(acc);
+        acc = acc >> 8;
+        n_acc -= 8;
+    }
+}
+
+inline uint64_t takeBits(const uint8_t*& in, uint64_t& acc, size_t& n_acc, size_t width)
+{
+    if (width > 32)
+    {
+        uint64_t low = takeBits(in, acc, n_acc, 32);
+        return low | (takeBits(in, acc, n_acc, width - 32) << 32);
+    }
+    while (n_acc < width)
+    {
+        acc |= static_cast<uint64_t>(*in++) << n_acc;
+        n_acc += 8;
+    }
+    uint64_t x = acc & ((static_cast<uint64_t>(1) << width) - 1);
+    acc = acc >> width;
+    n_acc -= width;
+    return x;
+}
+}
+
+
+//the encoders write whole units (a varint, a frame header or one packed value) into the buffer they are given and
+//stop at the first unit that does not fit, so a stream can be cut into packets of any size of at least
+//MIN_BUFFER_BYTES: call encode() with each free buffer until done()
+
+
+//bit vector as alternating run lengths: varint bit count, one byte with the value of the first run (0 or 1), then one
+//varint per run. Runs are found with findNextSet/findNextClear a block at a time
+template<class Bits>
+class RunLengthEncoder
+{
+    const Bits* bits_;
+    size_t pos_;
+    bool value_;
+    bool header_done_;
+
+public:
+    static const size_t MIN_BUFFER_BYTES = aux::MAX_VARINT_BYTES + 1;
+
+    bool done() const {return header_done_ && pos_ == bits_->size();};
+
+    //bytes written, 0 once done() or if n_bytes is below MIN_BUFFER_BYTES
+    size_t encode(uint8_t* buffer, size_t n_bytes)
+    {
+        uint8_t* out = buffer;
+        uint8_t* end = buffer + n_bytes;
+        if (!header_done_)
+        {
+            if (static_cast<size_t>(end - out) < aux::varintBytes(bits_->size()) + 1)
+            {
+                return 0;
+            }
+            value_ = bits_->size() != 0 && (*bits_)[0];
+            out = aux::writeVarint(out, bits_->size());
+            *out++ = value_ ? 1 : 0;
+            header_done_ = true;
+        }
+        while (pos_ < bits_->size())
+        {
+            size_t run_end = value_ ? bits_->findNextClear(pos_) : bits_->findNextSet(pos_);
+            if (static_cast<size_t>(end - out) < aux::varintBytes(run_end - pos_))
+            {
+                break;
+            }
+            out = aux::writeVarint(out, run_end - pos_);
+            pos_ = run_end;
+            value_ = !value_;
+        }
+        return out - buffer;
+    }
+
+    void restart()
+    {
+        pos_ = 0;
+        header_done_ = false;
+    }
+
+    RunLengthEncoder(const Bits& bits)
+        :bits_(&bits), pos_(0), value_(false), header_done_(false) {};
+};
+
+
+//integers as varint count, then the zigzagged difference to the previous value (starting from 0) as varints
+template<class T>
+class DeltaVarintEncoder
+{
+    typedef typename aux::EncodingWord<T>::type Word;
+
+    const T* data_;
+    size_t size_;
+    size_t i_;
+    Word previous_;
+    bool header_done_;
+
+public:
+    static const size_t MIN_BUFFER_BYTES = aux::MAX_VARINT_BYTES;
+
+    bool done() const {return header_done_ && i_ == size_;};
+
+    size_t encode(uint8_t* buffer, size_t n_bytes)
+    {
+        uint8_t* out = buffer;
+        uint8_t* end = buffer + n_bytes;
+        if (!header_done_)
+        {
+            if (static_cast<size_t>(end - out) < aux::varintBytes(size_))
+            {
+                return 0;
+            }
+            out = aux::writeVarint(out, size_);
+            header_done_ = true;
+        }
+        for (; i_ < size_; i_++)
+        {
+            Word x = static_cast<Word>(data_[i_]);
+            Word delta = aux::zigzagEncode(static_cast<Word>(x - previous_));
+            if (static_cast<size_t>(end - out) < aux::varintBytes(delta))
+            {
+                break;
+            }
+            out = aux::writeVarint(out, delta);
+            previous_ = x;
+        }
+        return out - buffer;
+    }
+
+    void restart()
+    {
+        i_ = 0;
+        previous_ = 0;
+        header_done_ = false;
+    }
+
+    DeltaVarintEncoder(const T* data, size_t n)
+        :data_(data), size_(n), i_(0), previous_(0), header_done_(false) {};
+
+    template<class Allocator, AllocationPolicyFunc allocPolicy>
+    DeltaVarintEncoder(const Vector<T, Allocator, allocPolicy>& x)
+        :DeltaVarintEncoder(x.data(), x.size()) {};
+};
+
+
+//integers as varint count, then frames of FRAME_SIZE values: varint frame minimum, one byte bit width, and every
+//value minus the minimum in that many bits, little endian and padded to a whole byte at the end of the frame
+template<class T>
+class FrameOfReferenceEncoder
+{
+    typedef typename aux::EncodingWord<T>::type Word;
+
+public:
+#if defined(ARDUINO)
+    static const size_t FRAME_SIZE = 16;
+#else
+    static const size_t FRAME_SIZE = 128;
+#endif
+    static const size_t MIN_BUFFER_BYTES = aux::MAX_VARINT_BYTES + 1;
+
+private:
+    const T* data_;
+    size_t size_;
+    size_t i_;
+    size_t frame_end_;
+    Word frame_min_;
+    size_t width_;
+    uint64_t acc_;
+    size_t n_acc_;
+    bool header_done_;
+
+    void measureFrame(size_t first, size_t last, Word& min, size_t& width) const
+    {
+        min = aux::orderedWord(data_[first]);
+        Word max = min;
+        for (size_t i = first + 1; i < last; i++)
+        {
+            Word x = aux::orderedWord(data_[i]);
+            min = x < min ? x : min;
+            max = x > max ? x : max;
+        }
+        width = max == min ? 0 : aux::findLastSet(static_cast<Word>(max - min)) + 1;
+    }
+
+public:
+    bool done() const {return header_done_ && i_ == size_;};
+
+    size_t encode(uint8_t* buffer, size_t n_bytes)
+    {
+        uint8_t* out = buffer;
+        uint8_t* end = buffer + n_bytes;
+        if (!header_done_)
+        {
+            if (static_cast<size_t>(end - out) < aux::varintBytes(size_))
+            {
+                return 0;
+            }
+            out = aux::writeVarint(out, size_);
+            header_done_ = true;
+        }
+        while (i_ < size_)
+        {
+            if (i_ == frame_end_)
+            {
+                size_t last = size_ - i_ > FRAME_SIZE ? i_ + FRAME_SIZE : size_;
+                Word min;
+                size_t width;
+                measureFrame(i_, last, min, width);
+                if (static_cast<size_t>(end - out) < aux::varintBytes(min) + 1)
+                {
+                    break;
+                }
+                out = aux::writeVarint(out, min);
+                *out++ = static_cast<uint8_t>(width);
+                frame_min_ = min;
+                width_ = width;
+                frame_end_ = last;
+            }
+            bool last_in_frame = i_ + 1 == frame_end_;
+            size_t n_out = last_in_frame ? (n_acc_ + width_ + 7) / 8 : (n_acc_ + width_) / 8;
+            if (static_cast<size_t>(end - out) < n_out)
+            {
+                break;
+            }
+            aux::putBits(out, acc_, n_acc_, static_cast<Word>(aux::orderedWord(data_[i_]) - frame_min_), width_);
+            if (last_in_frame && n_acc_ != 0)
+            {
+                *out++ = static_cast<uint8_t>(acc_);
+                acc_ = 0;
+                n_acc_ = 0;
+            }
+            i_++;
+        }
+        return out - buffer;
+    }
+
+    void restart()
+    {
+        i_ = 0;
+        frame_end_ = 0;
+        acc_ = 0;
+        n_acc_ = 0;
+        header_done_ = false;
+    }
+
+    FrameOfReferenceEncoder(const T* data, size_t n)
+        :data_(data), size_(n), i_(0), frame_end_(0), frame_min_(0), width_(0), acc_(0), n_acc_(0), header_done_(false) {};
+
+    template<class Allocator, AllocationPolicyFunc allocPolicy>
+    FrameOfReferenceEncoder(const Vector<T, Allocator, allocPolicy>& x)
+        :FrameOfReferenceEncoder(x.data(), x.size()) {};
+};
+
+
+//the decoders take a complete stream, size the container once from its header and fill it in place,
+//on malformed or truncated input they leave it empty and return false
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy>
+inline bool decodeRunLength(const uint8_t* buffer, size_t n_bytes, BitVector<T, Allocator, allocPolicy>& out)
+{
+    const uint8_t* ptr = buffer;
+    const uint8_t* end = buffer + n_bytes;
+    uint64_t n_bits;
+    out.resize(0);
+    ptr = aux::readVarint(ptr, end, n_bits);
+    if (ptr == nullptr || ptr == end || *ptr > 1 || !out.reserve(n_bits))
+    {
+        return false;
+    }
+    bool value = *ptr++ != 0;
+    size_t pos = 0;
+    while (pos < n_bits)
+    {
+        uint64_t run;
+        ptr = aux::readVarint(ptr, end, run);
+        if (ptr == nullptr || run == 0 || run > n_bits - pos)
+        {
+            out.resize(0);
+            return false;
+        }
+        out.resize(pos + run, value);
+        pos += run;
+        value = !value;
+    }
+    return true;
+}
+
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy>
+inline bool decodeDeltaVarint(const uint8_t* buffer, size_t n_bytes, Vector<T, Allocator, allocPolicy>& out)
+{
+    typedef typename aux::EncodingWord<T>::type Word;
+    const uint8_t* ptr = buffer;
+    const uint8_t* end = buffer + n_bytes;
+    uint64_t n;
+    out.clear();
+    ptr = aux::readVarint(ptr, end, n);
+    //every value takes at least one byte, a larger count is corrupt
+    if (ptr == nullptr || n > static_cast<size_t>(end - ptr) || !out.resizeDefaultInit(n))
+    {
+        return false;
+    }
+    T* data = out.data();
+    Word previous = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t delta;
+        ptr = aux::readVarint(ptr, end, delta);
+        if (ptr == nullptr)
+        {
+            out.clear();
+            return false;
+        }
+        previous = static_cast<Word>(previous + aux::zigzagDecode(static_cast<Word>(delta)));
+        data[i] = static_cast<T>(previous);
+    }
+    return true;
+}
+
+
+template<class T, class Allocator, AllocationPolicyFunc allocPolicy>
+inline bool decodeFrameOfReference(const uint8_t* buffer, size_t n_bytes, Vector<T, Allocator, allocPolicy>& out)
+{
+    typedef typename aux::EncodingWord<T>::type Word;
+    const size_t frame_size = FrameOfReferenceEncoder<T>::FRAME_SIZE;
+    const uint8_t* ptr = buffer;
+    const uint8_t* end = buffer + n_bytes;
+    uint64_t n;
+    out.clear();
+    ptr = aux::readVarint(ptr, end, n);
+    //every frame takes at least two bytes
+    if (ptr == nullptr || (n + frame_size - 1) / frame_size > static_cast<size_t>(end - ptr) / 2 || !out.resizeDefaultInit(n))
+    {
+        return false;
+    }
+    T* data = out.data();
+    for (size_t i = 0; i < n; )
+    {
+        uint64_t min;
+        ptr = aux::readVarint(ptr, end, min);
+        size_t frame_n = n - i > frame_size ? frame_size : n - i;
+        size_t width = ptr != nullptr && ptr != end ? *ptr++ : sizeof(Word) * 8 + 1;
+        if (width > sizeof(Word) * 8 || (frame_n * width + 7) / 8 > static_cast<size_t>(end - ptr))
+        {
+            out.clear();
+            return false;
+        }
+        const uint8_t* bits = ptr;
+        uint64_t acc = 0;
+        size_t n_acc = 0;
+        for (size_t k = 0; k < frame_n; k++, i++)
+        {
+            data[i] = aux::fromOrderedWord<T>(static_cast<Word>(min + aux::takeBits(bits, acc, n_acc, width)));
+        }
+        ptr += (frame_n * width + 7) / 8;
+    }
+    return true;
+}
+
+}
+
+#endif
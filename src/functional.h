@@ -37,6 +37,18 @@ public:
     virtual CallableBase<R(Args...)>* getCopy() override {return new Callable(f_);};
 };
 
+
+template<class Predicate>
+class NegatedPredicate
+{
+    Predicate pred_;
+public:
+    NegatedPredicate(Predicate pred)
+        :pred_(pred) {};
+    template<class X>
+    bool operator()(const X& x) {return !pred_(x);};
+};
+
 }
 
 
@@ -0,0 +1,350 @@
+#ifndef ASTL_HIERARCHICAL_BITVECTOR_H
+#define ASTL_HIERARCHICAL_BITVECTOR_H
+
+#include "bitvector.h"
+
+namespace astl
+{
+
+//bit vector with two summary trees kept up to date by set and reset: bit j of a non empty level marks block j of the
+//level below as holding a set bit, bit j of a non full level marks it as holding a clear bit. The finders climb to the
+//first level with a candidate and come back down, a handful of block operations however full or empty the bits are
+template<class T, class Allocator = HeapAllocator<T>, AllocationPolicyFunc allocPolicy = allocationPolicy2>
+class HierarchicalBitVector
+{
+public:
+    typedef BitVector<T, Allocator, allocPolicy> Bits;
+
+    //64 bit blocks cover 2^30 bits in four levels, a larger top level is scanned block by block
+    static const size_t MAX_LEVELS = 4;
+
+private:
+    static const size_t BITS_IN_BLOCK = BitBlock<T>::BITS_IN_BLOCK;
+    static const size_t NOT_FOUND = ~static_cast<size_t>(0);
+
+    Bits bits_;
+    Bits non_empty_[MAX_LEVELS];
+    Bits non_full_[MAX_LEVELS];
+    size_t n_levels_;
+
+    static T bitMask(size_t pos) {return static_cast<T>(BitBlock<T>::UNIT_BLOCK << (pos % BITS_IN_BLOCK));};
+    static T fromBit(size_t pos) {return static_cast<T>(static_cast<T>(~static_cast<T>(0)) << (pos % BITS_IN_BLOCK));};
+
+    //valid bits of block b, the padding of the last block counts as neither set nor clear
+    T fullMask(size_t b) const
+    {
+        size_t tail = bits_.size() % BITS_IN_BLOCK;
+        return b + 1 == bits_.sizeBytes() && tail != 0 ? aux::lowBitsMask<T>(tail) : static_cast<T>(~static_cast<T>(0));
+    }
+
+    T setBlock(size_t b) const {return static_cast<T>(bits_.data()[b] & fullMask(b));};
+    T clearBlock(size_t b) const {return static_cast<T>(~bits_.data()[b] & fullMask(b));};
+
+    //marks index in the bottom summary level and walks up until a block was already non zero
+    void markSummary(Bits* levels, size_t index)
+    {
+        for (size_t l = 0; l < n_levels_; l++)
+        {
+            T& block = levels[l].data()[index / BITS_IN_BLOCK];
+            bool was_zero = block == 0;
+            block = static_cast<T>(block | bitMask(index));
+            if (!was_zero)
+            {
+                return;
+            }
+            index = index / BITS_IN_BLOCK;
+        }
+    }
+
+    //unmarks index and walks up while blocks become zero
+    void unmarkSummary(Bits* levels, size_t index)
+    {
+        for (size_t l = 0; l < n_levels_; l++)
+        {
+            T& block = levels[l].data()[index / BITS_IN_BLOCK];
+            block = static_cast<T>(block & ~bitMask(index));
+            if (block != 0)
+            {
+                return;
+            }
+            index = index / BITS_IN_BLOCK;
+        }
+    }
+
+    //first marked index >= index in summary level l, NOT_FOUND if none
+    size_t nextMarked(const Bits* levels, size_t l, size_t index) const
+    {
+        const Bits& level = levels[l];
+        if (index >= level.size())
+        {
+            return NOT_FOUND;
+        }
+        const T* data = level.data();
+        size_t b = index / BITS_IN_BLOCK;
+        T block = static_cast<T>(data[b] & fromBit(index));
+        if (block == 0)
+        {
+            if (l + 1 == n_levels_)
+            {
+                b = aux::skipBlocks(data, b + 1, level.sizeBytes(), static_cast<T>(0));
+                if (b == level.sizeBytes())
+                {
+                    return NOT_FOUND;
+                }
+            }
+            else
+            {
+                b = nextMarked(levels, l + 1, b + 1);
+                if (b == NOT_FOUND)
+                {
+                    return NOT_FOUND;
+                }
+            }
+            block = data[b];
+        }
+        return b * BITS_IN_BLOCK + aux::countTrailingZeros(block);
+    }
+
+    static bool buildLevel(Bits& level, size_t n_below)
+    {
+        if (!level.resize(n_below))
+        {
+            return false;
+        }
+        ::memset(level.data(), 0, level.sizeBytes() * sizeof(T));
+        return true;
+    }
+
+    //false if a summary level could not be allocated, the summaries are then unusable until the next successful build
+    bool build()
+    {
+        n_levels_ = 0;
+        size_t n_below = bits_.sizeBytes();
+        while (n_below > 1 && n_levels_ < MAX_LEVELS)
+        {
+            if (!buildLevel(non_empty_[n_levels_], n_below) || !buildLevel(non_full_[n_levels_], n_below))
+            {
+                n_levels_ = 0;
+                return false;
+            }
+            n_below = non_empty_[n_levels_].sizeBytes();
+            n_levels_++;
+        }
+        for (size_t l = n_levels_; l < MAX_LEVELS; l++)
+        {
+            non_empty_[l].resize(0);
+            non_full_[l].resize(0);
+        }
+        if (n_levels_ == 0)
+        {
+            return true;
+        }
+
+        for (size_t b = 0; b < bits_.sizeBytes(); b++)
+        {
+            if (setBlock(b) != 0)
+            {
+                non_empty_[0].data()[b / BITS_IN_BLOCK] |= bitMask(b);
+            }
+            if (clearBlock(b) != 0)
+            {
+                non_full_[0].data()[b / BITS_IN_BLOCK] |= bitMask(b);
+            }
+        }
+        for (size_t l = 1; l < n_levels_; l++)
+        {
+            for (size_t b = 0; b < non_empty_[l - 1].sizeBytes(); b++)
+            {
+                if (non_empty_[l - 1].data()[b] != 0)
+                {
+                    non_empty_[l].data()[b / BITS_IN_BLOCK] |= bitMask(b);
+                }
+                if (non_full_[l - 1].data()[b] != 0)
+                {
+                    non_full_[l].data()[b / BITS_IN_BLOCK] |= bitMask(b);
+                }
+            }
+        }
+        return true;
+    }
+
+    //the constructors can not report a failed build, they leave the vector empty instead
+    void buildOrClear()
+    {
+        if (!build())
+        {
+            bits_.resize(0);
+            build();
+        }
+    }
+
+    //first position >= pos whose bit is set in the blocks pick returns, the summaries are consulted past pos's block
+    template<class Pick>
+    size_t findNext(size_t pos, const Bits* levels, Pick pick) const
+    {
+        if (pos >= bits_.size())
+        {
+            return bits_.size();
+        }
+        size_t b = pos / BITS_IN_BLOCK;
+        T block = static_cast<T>(pick(b) & fromBit(pos));
+        if (block == 0)
+        {
+            if (n_levels_ == 0)
+            {
+                return bits_.size();
+            }
+            b = nextMarked(levels, 0, b + 1);
+            if (b == NOT_FOUND)
+            {
+                return bits_.size();
+            }
+            block = pick(b);
+        }
+        return b * BITS_IN_BLOCK + aux::countTrailingZeros(block);
+    }
+
+public:
+    const Bits& bits() const {return bits_;};
+    size_t size() const {return bits_.size();};
+    size_t count() const {return bits_.count();};
+    bool none() const {return findFirstSet() == size();};
+    bool all() const {return findFirstClear() == size();};
+
+    bool operator[](size_t pos) const {return bits_[pos];};
+    bool test(size_t pos) const {return bits_[pos];};
+
+    //bytes used by the summaries on top of the bits
+    size_t summaryBytes() const
+    {
+        size_t n = 0;
+        for (size_t l = 0; l < n_levels_; l++)
+        {
+            n += (non_empty_[l].sizeBytes() + non_full_[l].sizeBytes()) * sizeof(T);
+        }
+        return n;
+    }
+
+    void set(size_t pos)
+    {
+        size_t b = pos / BITS_IN_BLOCK;
+        T& block = bits_.data()[b];
+        T old = block;
+        block = static_cast<T>(block | bitMask(pos));
+        if (n_levels_ == 0 || old == block)
+        {
+            return;
+        }
+        if ((old & fullMask(b)) == 0)
+        {
+            markSummary(non_empty_, b);
+        }
+        if (clearBlock(b) == 0)
+        {
+            unmarkSummary(non_full_, b);
+        }
+    }
+
+    void reset(size_t pos)
+    {
+        size_t b = pos / BITS_IN_BLOCK;
+        T& block = bits_.data()[b];
+        T old = block;
+        block = static_cast<T>(block & ~bitMask(pos));
+        if (n_levels_ == 0 || old == block)
+        {
+            return;
+        }
+        if ((~old & fullMask(b)) == 0)
+        {
+            markSummary(non_full_, b);
+        }
+        if (setBlock(b) == 0)
+        {
+            unmarkSummary(non_empty_, b);
+        }
+    }
+
+    void set(size_t pos, bool value)
+    {
+        if (value)
+        {
+            set(pos);
+        }
+        else
+        {
+            reset(pos);
+        }
+    }
+
+    //set and reset returning the previous value, e.g. to claim and release slots
+    bool testAndSet(size_t pos)
+    {
+        bool old = bits_[pos];
+        set(pos);
+        return old;
+    }
+
+    bool testAndClear(size_t pos)
+    {
+        bool old = bits_[pos];
+        reset(pos);
+        return old;
+    }
+
+    //positions of the first set/clear bit at or after pos, size() if there is none
+    size_t findNextSet(size_t pos) const
+    {
+        return findNext(pos, non_empty_, [this](size_t b){return setBlock(b);});
+    }
+
+    size_t findNextClear(size_t pos) const
+    {
+        return findNext(pos, non_full_, [this](size_t b){return clearBlock(b);});
+    }
+
+    size_t findFirstSet() const {return findNextSet(0);};
+    size_t findFirstClear() const {return findNextClear(0);};
+
+    //the summaries are rebuilt in one pass, new bits take value. If the summaries do not fit the old size is restored
+    bool resize(size_t n, bool value = false)
+    {
+        size_t old_size = bits_.size();
+        if (!bits_.resize(n, value))
+        {
+            return false;
+        }
+        if (build())
+        {
+            return true;
+        }
+        bits_.resize(old_size);
+        buildOrClear();
+        return false;
+    }
+
+    HierarchicalBitVector()
+        :n_levels_(0) {};
+
+    HierarchicalBitVector(size_t n, bool value = false)
+        :bits_(n, value)
+    {
+        buildOrClear();
+    }
+
+    HierarchicalBitVector(const Bits& bits)
+        :bits_(bits)
+    {
+        buildOrClear();
+    }
+
+    HierarchicalBitVector(Bits&& bits)
+        :bits_(std::move(bits))
+    {
+        buildOrClear();
+    }
+};
+
+}
+
+#endif
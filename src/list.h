@@ -4,6 +4,7 @@
 #include "arena.h"
 #include "initializer_list.h"
 #include "type_traits.h"
+#include "functional.h"
 
 namespace astl
 {
@@ -14,6 +15,23 @@ template <class T> class ListNodeIterator;
 template<class T, class Arena = HeapArena<ListNode<T>>> class List;
 
 
+namespace aux
+{
+//nodes of a moved list stay in their arena, so a movable arena travels with them
+template<class Arena>
+Arena takeArena(Arena& arena, std::true_type)
+{
+    return std::move(arena);
+}
+
+template<class Arena>
+Arena takeArena(Arena& arena, std::false_type)
+{
+    return Arena();
+}
+}
+
+
 template <class T>
 class ListNode
 {
@@ -280,6 +298,7 @@ public:
         if (it == begin())
         {
             head_ = head_->next;
+            head_->prev = nullptr;
         }
         else
         {
@@ -299,6 +318,34 @@ public:
         return next_it;
     }
     
+    template<class Predicate>
+    size_t eraseIf(Predicate pred)
+    {
+        size_t n_erased = 0;
+        auto it = begin();
+        while (it != end())
+        {
+            if (pred(*it))
+            {
+                it = erase(it);
+                n_erased++;
+            }
+            else
+            {
+                it++;
+            }
+        }
+        return n_erased;
+    }
+
+
+    template<class Predicate>
+    size_t retain(Predicate pred)
+    {
+        return eraseIf(aux::NegatedPredicate<Predicate>(pred));
+    }
+    
+
     iterator popBack()
     {
         return erase(end_->prev);
@@ -311,6 +358,14 @@ public:
     
     void clear()
     {
+        if (aux::isMonotonic<Arena>(0) && std::is_trivially_destructible<T>::value)
+        {//nodes are reclaimed with the arena's buffer, nothing to run per node
+            head_ = end_;
+            end_->prev = nullptr;
+            size_ = 0;
+            return;
+        }
+
         auto node_ptr = head_;
         while(node_ptr != end_)
         {
@@ -338,6 +393,7 @@ public:
 
 
 	List(List&& l)
+		:arena_(aux::takeArena(l.arena_, std::integral_constant<bool, Arena::is_movable>()))
 	{
 		if (arena_.is_movable)
 		{
@@ -383,36 +439,34 @@ public:
 
 	List& operator=(List&& l)
 	{
-		if (this == l)
+		if (this == &l)
 		{
-			return this;
+			return *this;
 		}
 
+		clear();
 		if (arena_.is_movable)
 		{
+			arena_.destroy(end_);
+			arena_ = std::move(l.arena_);
 			head_ = l.head_;
 			end_ = l.end_;
 			size_ = l.size_;
 			l.initialize();
-            return this;
+			return *this;
 		}
 
-		if (this != l)
+		auto it = l.begin();
+		while( it != l.end())
 		{
-			clear();
-            auto it = l.begin();
-            while( it != l.end())
-            {
-                insert(end_, *it);
-                it = l.erase(it);
-            }
+			insert(end_, *it);
+			it = l.erase(it);
 		}
-		return this;
+		return *this;
 	}
 
 
 
-    
     template<class X, class Arena2>
     List& operator=(const List<X, Arena2>& l)
     {
@@ -128,6 +128,27 @@ void memclear(T* src, size_t len)
 }
 
 
+//copy constructs len objects from src into uninitialized memory at dest
+template<class T>
+void mem_init_copy(T* dest, const T* src, size_t len)
+{
+	if (len == 0)
+	{
+		return;
+	}
+	if (std::is_trivially_copyable<T>::value)
+	{
+		::memcpy(dest, src, len * sizeof(T));
+		return;
+	}
+
+	for (size_t i = 0; i < len; i++)
+	{
+		new (dest + i) T(src[i]);
+	}
+}
+
+
 template<class T, class ...Args>
 void mem_init(T* src, size_t len, Args&&... args)
 {    
@@ -0,0 +1,386 @@
+#ifndef ASTL_MEMORY_RESOURCE_H
+#define ASTL_MEMORY_RESOURCE_H
+
+#include "allocator.h"
+
+namespace astl
+{
+
+//runtime interface behind PolymorphicAllocator/PolymorphicArena, so several containers can draw from one pool
+class MemoryResource
+{
+public:
+    virtual void* allocate(size_t n_bytes, size_t alignment) = 0;
+    virtual bool deallocate(void* ptr, size_t n_bytes) = 0;
+    virtual bool tryExpand(void*, size_t, size_t) {return false;};
+    virtual size_t maxBytes() const = 0;
+
+    virtual ~MemoryResource() {};
+};
+
+
+class NewDeleteResource : public MemoryResource
+{
+public:
+    void* allocate(size_t n_bytes, size_t) override
+    {
+        if (n_bytes == 0)
+        {
+            return nullptr;
+        }
+        return new uint8_t[n_bytes];
+    }
+
+    bool deallocate(void* ptr, size_t) override
+    {
+        delete[] static_cast<uint8_t*>(ptr);
+        return true;
+    }
+
+    size_t maxBytes() const override {return HeapAllocator<uint8_t>().maxSize();};
+};
+
+
+namespace aux
+{
+template<class Resource>
+auto resourceMaxBytes(const Resource& resource, int) -> decltype(resource.maxBytes())
+{
+    return resource.maxBytes();
+}
+
+template<class Resource>
+size_t resourceMaxBytes(const Resource&, long)
+{//no limit reported, assume the heap's
+    return HeapAllocator<uint8_t>().maxSize();
+}
+
+inline MemoryResource* newDeleteResource()
+{
+    static NewDeleteResource new_delete;
+    return &new_delete;
+}
+
+inline MemoryResource*& defaultResource()
+{
+    static MemoryResource* resource = newDeleteResource();
+    return resource;
+}
+}
+
+
+inline MemoryResource* getDefaultResource()
+{
+    return aux::defaultResource();
+}
+
+
+//returns the previous default, nullptr restores new/delete
+inline MemoryResource* setDefaultResource(MemoryResource* resource)
+{
+    MemoryResource* old = aux::defaultResource();
+    aux::defaultResource() = resource == nullptr ? aux::newDeleteResource() : resource;
+    return old;
+}
+
+
+//containers constructed while this is alive draw from resource and keep it for their lifetime
+class ScopedDefaultResource
+{
+    MemoryResource* previous_;
+
+public:
+    ScopedDefaultResource(MemoryResource* resource)
+        :previous_(setDefaultResource(resource)) {};
+
+    ~ScopedDefaultResource()
+    {
+        setDefaultResource(previous_);
+    }
+
+    ScopedDefaultResource(const ScopedDefaultResource&) = delete;
+    ScopedDefaultResource& operator=(const ScopedDefaultResource&) = delete;
+};
+
+
+//exposes MonotonicBuffer, TlsfResource or any class with the same allocate/deallocate/tryExpand/maxBytes members,
+//the largest request the wrapped resource can currently satisfy is passed on as maxBytes()
+template<class Resource>
+class MemoryResourceAdaptor : public MemoryResource
+{
+    Resource* resource_;
+
+public:
+    void* allocate(size_t n_bytes, size_t alignment) override
+    {
+        return resource_->allocate(n_bytes, alignment);
+    }
+
+    bool deallocate(void* ptr, size_t n_bytes) override
+    {
+        return resource_->deallocate(ptr, n_bytes);
+    }
+
+    bool tryExpand(void* ptr, size_t old_bytes, size_t new_bytes) override
+    {
+        return resource_->tryExpand(ptr, old_bytes, new_bytes);
+    }
+
+    size_t maxBytes() const override {return aux::resourceMaxBytes(*resource_, 0);};
+
+    MemoryResourceAdaptor(Resource* resource)
+        :resource_(resource) {};
+};
+
+
+//power of two size classes carved from one region, freed blocks go back to their class and are reused by any container
+class SizeClassPoolResource : public MemoryResource
+{
+public:
+#if defined(ARDUINO)
+    static const size_t MIN_CLASS_SIZE = 4;
+    static const size_t N_CLASSES = 7;
+#else
+    static const size_t MIN_CLASS_SIZE = 16;
+    static const size_t N_CLASSES = 8;
+#endif
+    static const size_t MAX_CLASS_SIZE = MIN_CLASS_SIZE << (N_CLASSES - 1);
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    FreeBlock* free_lists_[N_CLASSES];
+    uint8_t* begin_;
+    uint8_t* top_;
+    uint8_t* end_;
+    MemoryResource* upstream_;
+    size_t used_bytes_;
+
+    static size_t classIndex(size_t n_bytes)
+    {
+        size_t index = 0;
+        size_t class_size = MIN_CLASS_SIZE;
+        while (class_size < n_bytes && index < N_CLASSES)
+        {
+            class_size = class_size << 1;
+            index++;
+        }
+        return index;
+    }
+
+    static size_t classSize(size_t index) {return MIN_CLASS_SIZE << index;};
+
+    bool owns(void* ptr) const
+    {
+        uint8_t* byte_ptr = static_cast<uint8_t*>(ptr);
+        return byte_ptr >= begin_ && byte_ptr < end_;
+    }
+
+    void pushFree(size_t index, void* ptr)
+    {
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = free_lists_[index];
+        free_lists_[index] = block;
+    }
+
+    void* popFree(size_t index)
+    {
+        FreeBlock* block = free_lists_[index];
+        free_lists_[index] = block->next;
+        return block;
+    }
+
+    //free list first, then the untouched tail of the region, then halves of a larger free block
+    void* allocateClass(size_t index)
+    {
+        if (free_lists_[index] != nullptr)
+        {
+            return popFree(index);
+        }
+        size_t size = classSize(index);
+        if (size <= static_cast<size_t>(end_ - top_))
+        {
+            void* ptr = top_;
+            top_ += size;
+            return ptr;
+        }
+        for (size_t larger = index + 1; larger < N_CLASSES; larger++)
+        {
+            if (free_lists_[larger] != nullptr)
+            {
+                uint8_t* ptr = static_cast<uint8_t*>(popFree(larger));
+                while (larger > index)
+                {
+                    larger--;
+                    pushFree(larger, ptr + classSize(larger));
+                }
+                return ptr;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    size_t totalBytes() const {return end_ - begin_;};
+    size_t usedBytes() const {return used_bytes_;};//rounded up to the size classes
+    size_t untouchedBytes() const {return end_ - top_;};
+
+    void* allocate(size_t n_bytes, size_t alignment) override
+    {
+        if (n_bytes == 0)
+        {
+            return nullptr;
+        }
+        size_t index = classIndex(n_bytes);
+        if (index < N_CLASSES && alignment <= MIN_CLASS_SIZE)
+        {
+            void* ptr = allocateClass(index);
+            if (ptr != nullptr)
+            {
+                used_bytes_ += classSize(index);
+                return ptr;
+            }
+        }
+        return upstream_ == nullptr ? nullptr : upstream_->allocate(n_bytes, alignment);
+    }
+
+    bool deallocate(void* ptr, size_t n_bytes) override
+    {
+        if (ptr == nullptr)
+        {
+            return true;
+        }
+        if (!owns(ptr))
+        {
+            return upstream_ != nullptr && upstream_->deallocate(ptr, n_bytes);
+        }
+        size_t index = classIndex(n_bytes);
+        if (index >= N_CLASSES)
+        {
+            return false;
+        }
+        pushFree(index, ptr);
+        used_bytes_ -= classSize(index);
+        return true;
+    }
+
+    //a block can grow up to the size of its class without moving
+    bool tryExpand(void* ptr, size_t old_bytes, size_t new_bytes) override
+    {
+        if (!owns(ptr))
+        {
+            return upstream_ != nullptr && upstream_->tryExpand(ptr, old_bytes, new_bytes);
+        }
+        return new_bytes <= classSize(classIndex(old_bytes));
+    }
+
+    size_t maxBytes() const override
+    {
+        return upstream_ != nullptr && upstream_->maxBytes() > MAX_CLASS_SIZE ? upstream_->maxBytes() : MAX_CLASS_SIZE;
+    }
+
+    SizeClassPoolResource(void* region, size_t n_bytes, MemoryResource* upstream = nullptr)
+        :begin_(static_cast<uint8_t*>(region)), top_(nullptr), end_(static_cast<uint8_t*>(region) + n_bytes), upstream_(upstream), used_bytes_(0)
+    {
+        for (size_t i = 0; i < N_CLASSES; i++)
+        {
+            free_lists_[i] = nullptr;
+        }
+        uintptr_t addr = reinterpret_cast<uintptr_t>(begin_);
+        size_t offset = (MIN_CLASS_SIZE - addr % MIN_CLASS_SIZE) % MIN_CLASS_SIZE;
+        top_ = offset < n_bytes ? begin_ + offset : end_;
+    }
+
+    SizeClassPoolResource(const SizeClassPoolResource&) = delete;
+    SizeClassPoolResource& operator=(const SizeClassPoolResource&) = delete;
+};
+
+
+//the resource is taken from getDefaultResource() at construction unless given explicitly, and travels with moves
+template<class T>
+class PolymorphicAllocator
+{
+    MemoryResource* resource_;
+
+public:
+    static const bool is_movable = true;
+    size_t maxSize() const {return resource_->maxBytes()/sizeof(T);};
+
+    MemoryResource* resource() const {return resource_;};
+
+    T* allocate(size_t n)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    bool deallocate(T* ptr, size_t n)
+    {
+        if (ptr == nullptr)
+        {
+            return true;
+        }
+        return resource_->deallocate(ptr, n * sizeof(T));
+    }
+
+    bool tryExpand(T* ptr, size_t old_n, size_t new_n)
+    {
+        return resource_->tryExpand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    PolymorphicAllocator()
+        :resource_(getDefaultResource()) {};
+
+    PolymorphicAllocator(MemoryResource* resource)
+        :resource_(resource) {};
+};
+
+
+template<class T>
+class PolymorphicArena
+{
+    MemoryResource* resource_;
+
+public:
+    static const bool is_movable = true;
+    static const bool is_monotonic = false;
+
+    MemoryResource* resource() const {return resource_;};
+
+    template <class ...Args>
+    T* create(Args&&... args)
+    {
+        void* ptr = resource_->allocate(sizeof(T), alignof(T));
+        if (ptr == nullptr)
+        {
+            return nullptr;
+        }
+        return new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    bool destroy(T* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+        ptr->~T();
+        return resource_->deallocate(ptr, sizeof(T));
+    }
+
+    PolymorphicArena()
+        :resource_(getDefaultResource()) {};
+
+    PolymorphicArena(MemoryResource* resource)
+        :resource_(resource) {};
+};
+
+}
+
+#endif
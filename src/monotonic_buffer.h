@@ -0,0 +1,163 @@
+#ifndef ASTL_MONOTONIC_BUFFER_H
+#define ASTL_MONOTONIC_BUFFER_H
+
+#include "memory_operations.h"
+
+namespace astl
+{
+
+class MonotonicBuffer
+{
+    uint8_t* begin_;
+    uint8_t* end_;
+    uint8_t* top_;
+    bool owns_region_;
+
+    static uint8_t* alignUp(uint8_t* ptr, size_t alignment)
+    {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+        return ptr + ((alignment - addr % alignment) % alignment);
+    }
+
+public:
+
+    size_t capacity() const {return end_ - begin_;};
+    size_t used() const {return top_ - begin_;};
+    size_t available() const {return end_ - top_;};
+    size_t maxBytes() const {return available();};
+
+    void* allocate(size_t n_bytes, size_t alignment = 1)
+    {
+        uint8_t* ptr = alignUp(top_, alignment);
+        if (ptr > end_ || n_bytes > static_cast<size_t>(end_ - ptr))
+        {
+            return nullptr;
+        }
+        top_ = ptr + n_bytes;
+        return ptr;
+    }
+
+    //only the block ending at the top of the buffer can grow
+    bool tryExpand(void* ptr, size_t old_bytes, size_t new_bytes)
+    {
+        uint8_t* byte_ptr = static_cast<uint8_t*>(ptr);
+        if (byte_ptr + old_bytes != top_ || new_bytes > static_cast<size_t>(end_ - byte_ptr))
+        {
+            return false;
+        }
+        top_ = byte_ptr + new_bytes;
+        return true;
+    }
+
+    //memory is reclaimed only when the freed block is the last one allocated
+    bool deallocate(void* ptr, size_t n_bytes)
+    {
+        uint8_t* byte_ptr = static_cast<uint8_t*>(ptr);
+        if (byte_ptr < begin_ || byte_ptr > end_)
+        {
+            return false;
+        }
+        if (byte_ptr + n_bytes == top_)
+        {
+            top_ = byte_ptr;
+        }
+        return true;
+    }
+
+    //frees every allocation at once, containers still pointing into the buffer must be dropped first
+    void reset()
+    {
+        top_ = begin_;
+    }
+
+    MonotonicBuffer(void* region, size_t n_bytes)
+        :begin_(static_cast<uint8_t*>(region)), end_(static_cast<uint8_t*>(region) + n_bytes), top_(static_cast<uint8_t*>(region)), owns_region_(false) {};
+
+    MonotonicBuffer(size_t n_bytes)
+        :begin_(new uint8_t[n_bytes]), end_(nullptr), top_(nullptr), owns_region_(true)
+    {
+        end_ = begin_ == nullptr ? nullptr : begin_ + n_bytes;
+        top_ = begin_;
+    }
+
+    ~MonotonicBuffer()
+    {
+        if (owns_region_)
+        {
+            delete[] begin_;
+        }
+    }
+
+    MonotonicBuffer(const MonotonicBuffer&) = delete;
+    MonotonicBuffer& operator=(const MonotonicBuffer&) = delete;
+};
+
+
+template<class T, MonotonicBuffer* buffer>
+class MonotonicAllocator
+{
+public:
+    static const bool is_movable = true;
+    size_t maxSize() const {return buffer->available()/sizeof(T);};
+
+    T* allocate(size_t n)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        return static_cast<T*>(buffer->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    bool deallocate(T* ptr, size_t n)
+    {
+        if (ptr == nullptr)
+        {
+            return true;
+        }
+        return buffer->deallocate(ptr, n * sizeof(T));
+    }
+
+    bool tryExpand(T* ptr, size_t old_n, size_t new_n)
+    {
+        return buffer->tryExpand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    MonotonicAllocator() {};
+};
+
+
+template<class T, MonotonicBuffer* buffer>
+class MonotonicArena
+{
+public:
+    static const bool is_movable = true;
+    static const bool is_monotonic = true;
+
+    MonotonicArena() {};
+
+    template <class ...Args>
+    T* create(Args&&... args)
+    {
+        void* ptr = buffer->allocate(sizeof(T), alignof(T));
+        if (ptr == nullptr)
+        {
+            return nullptr;
+        }
+        return new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    bool destroy(T* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+        ptr->~T();
+        return buffer->deallocate(ptr, sizeof(T));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef ASTL_MPMC_QUEUE_H
+#define ASTL_MPMC_QUEUE_H
+
+#include "allocator.h"
+
+#if !defined(ARDUINO)
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace astl
+{
+
+namespace aux
+{
+template<class T>
+struct MpmcCell
+{
+    std::atomic<size_t> sequence;
+    alignas(T) uint8_t storage[sizeof(T)];
+
+    T* value() {return reinterpret_cast<T*>(storage);};
+};
+}
+
+
+struct MpmcQueueStats
+{
+    size_t push_retries;//lost CAS races between producers
+    size_t pop_retries;//lost CAS races between consumers
+    size_t push_full;
+    size_t pop_empty;
+    size_t push_waits;
+    size_t pop_waits;
+};
+
+
+//bounded multi producer multi consumer queue, every cell carries a sequence number telling whose turn it is (D. Vyukov)
+template<class T, class Allocator = HeapAllocator<aux::MpmcCell<T>>>
+class MpmcQueue
+{
+    typedef aux::MpmcCell<T> Cell;
+
+    Cell* cells_;
+    size_t capacity_;
+    Allocator allocator_;
+
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_;
+
+    alignas(64) std::atomic<size_t> push_retries_;
+    std::atomic<size_t> pop_retries_;
+    std::atomic<size_t> push_full_;
+    std::atomic<size_t> pop_empty_;
+    std::atomic<size_t> push_waits_;
+    std::atomic<size_t> pop_waits_;
+
+    std::atomic<size_t> waiters_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+
+    static void increment(std::atomic<size_t>& counter)
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void wakeWaiters(std::condition_variable& cv)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) != 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv.notify_all();
+        }
+    }
+
+    Cell* claimPush()
+    {
+        if (capacity_ == 0)
+        {
+            return nullptr;
+        }
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell* cell = &cells_[pos & (capacity_ - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return cell;
+                }
+                increment(push_retries_);
+            }
+            else if (diff < 0)
+            {
+                increment(push_full_);
+                return nullptr;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publishPush(Cell* cell)
+    {
+        cell->sequence.store(cell->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void releasePop(Cell* cell, size_t pos)
+    {
+        cell->value()->~T();
+        cell->sequence.store(pos + capacity_, std::memory_order_release);
+    }
+
+    Cell* claimPop(size_t& pos)
+    {
+        if (capacity_ == 0)
+        {
+            return nullptr;
+        }
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell* cell = &cells_[pos & (capacity_ - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return cell;
+                }
+                increment(pop_retries_);
+            }
+            else if (diff < 0)
+            {
+                increment(pop_empty_);
+                return nullptr;
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    size_t capacity() const {return capacity_;};
+
+    //approximate under concurrent use
+    size_t size() const
+    {
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    MpmcQueueStats stats() const
+    {
+        MpmcQueueStats s;
+        s.push_retries = push_retries_.load(std::memory_order_relaxed);
+        s.pop_retries = pop_retries_.load(std::memory_order_relaxed);
+        s.push_full = push_full_.load(std::memory_order_relaxed);
+        s.pop_empty = pop_empty_.load(std::memory_order_relaxed);
+        s.push_waits = push_waits_.load(std::memory_order_relaxed);
+        s.pop_waits = pop_waits_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void resetStats()
+    {
+        push_retries_ = 0;
+        pop_retries_ = 0;
+        push_full_ = 0;
+        pop_empty_ = 0;
+        push_waits_ = 0;
+        pop_waits_ = 0;
+    }
+
+
+    template<class ...Args>
+    bool tryEmplace(Args&&... args)
+    {
+        Cell* cell = claimPush();
+        if (cell == nullptr)
+        {
+            return false;
+        }
+        new (cell->value()) T(std::forward<Args>(args)...);
+        publishPush(cell);
+        wakeWaiters(not_empty_);
+        return true;
+    }
+
+
+    bool tryPush(const T& x)
+    {
+        return tryEmplace(x);
+    }
+
+
+    bool tryPop(T& x)
+    {
+        size_t pos;
+        Cell* cell = claimPop(pos);
+        if (cell == nullptr)
+        {
+            return false;
+        }
+        x = std::move(*cell->value());
+        releasePop(cell, pos);
+        wakeWaiters(not_full_);
+        return true;
+    }
+
+
+    size_t tryPopN(T* x, size_t n)
+    {
+        size_t n_popped = 0;
+        while (n_popped < n && tryPop(x[n_popped]))
+        {
+            n_popped++;
+        }
+        return n_popped;
+    }
+
+
+    //blocking variants, the lock is only touched once the queue has been found full or empty
+    void push(const T& x)
+    {
+        if (tryPush(x))
+        {
+            return;
+        }
+        increment(push_waits_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        not_full_.wait(lock, [&]{return tryPushLocked(x);});
+        waiters_.fetch_sub(1);
+    }
+
+
+    void pop(T& x)
+    {
+        if (tryPop(x))
+        {
+            return;
+        }
+        increment(pop_waits_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        not_empty_.wait(lock, [&]{return tryPopLocked(x);});
+        waiters_.fetch_sub(1);
+    }
+
+
+    MpmcQueue(size_t min_capacity)
+        :cells_(nullptr), capacity_(0), allocator_(), enqueue_pos_(0), dequeue_pos_(0),
+         push_retries_(0), pop_retries_(0), push_full_(0), pop_empty_(0), push_waits_(0), pop_waits_(0), waiters_(0)
+    {
+        size_t capacity = 2;
+        while (capacity < min_capacity)
+        {
+            capacity = capacity << 1;
+        }
+        cells_ = allocator_.allocate(capacity);
+        if (cells_ == nullptr)
+        {
+            return;
+        }
+        capacity_ = capacity;
+        for (size_t i = 0; i < capacity_; i++)
+        {
+            new (&cells_[i].sequence) std::atomic<size_t>(i);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue()
+    {
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        for (size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != tail; pos++)
+        {
+            cells_[pos & (capacity_ - 1)].value()->~T();
+        }
+        allocator_.deallocate(cells_, capacity_);
+    }
+
+private:
+    //called with mutex_ held, so waking the other side must not take it again
+    bool tryPushLocked(const T& x)
+    {
+        Cell* cell = claimPush();
+        if (cell == nullptr)
+        {
+            return false;
+        }
+        new (cell->value()) T(x);
+        publishPush(cell);
+        not_empty_.notify_all();
+        return true;
+    }
+
+    bool tryPopLocked(T& x)
+    {
+        size_t pos;
+        Cell* cell = claimPop(pos);
+        if (cell == nullptr)
+        {
+            return false;
+        }
+        x = std::move(*cell->value());
+        releasePop(cell, pos);
+        not_full_.notify_all();
+        return true;
+    }
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef ASTL_PACKED_VECTOR_H
+#define ASTL_PACKED_VECTOR_H
+
+#include "bitvector.h"
+
+namespace astl
+{
+
+namespace aux
+{
+#if defined(ARDUINO)
+typedef uint8_t PackedBlock;
+#else
+typedef uint64_t PackedBlock;
+#endif
+
+//compile time widths take no room, width 0 means the width is given at construction
+template<size_t Bits>
+struct PackedWidth
+{
+    static constexpr size_t width() {return Bits;};
+
+    PackedWidth(size_t) {};
+    PackedWidth() {};
+};
+
+template<>
+struct PackedWidth<0>
+{
+    size_t width_;
+
+    size_t width() const {return width_;};
+
+    //widths outside 1 to 32 are clamped into it
+    PackedWidth(size_t width)
+        :width_(width == 0 ? 1 : (width > 32 ? 32 : width)) {};
+};
+}
+
+
+template<class Container>
+class PackedReference
+{
+    Container* container_;
+    size_t pos_;
+
+public:
+    operator uint32_t() const {return container_->get(pos_);};
+
+    PackedReference& operator=(uint32_t x)
+    {
+        container_->set(pos_, x);
+        return *this;
+    }
+
+    PackedReference& operator=(const PackedReference& x)
+    {
+        return this->operator=(static_cast<uint32_t>(x));
+    }
+
+    PackedReference(const PackedReference& x) = default;
+    PackedReference(Container* container, size_t pos)
+        :container_(container), pos_(pos) {};
+};
+
+
+//unsigned values of width bits (1 to 32) stored back to back across block boundaries
+template<size_t Bits = 0, class Block = aux::PackedBlock, class Allocator = HeapAllocator<Block>, AllocationPolicyFunc allocPolicy = allocationPolicy2>
+class PackedVector : private aux::PackedWidth<Bits>
+{
+    static_assert(Bits <= 32, "PackedVector holds at most 32 bit values");
+
+    BitVector<Block, Allocator, allocPolicy> bits_;
+    size_t size_;
+
+    using aux::PackedWidth<Bits>::width;
+
+#if !defined(ARDUINO)
+    //reads a value through an unaligned 64 bit window, the window must lie inside the storage
+    static uint32_t loadWindow(const uint8_t* bytes, size_t pos, size_t width)
+    {
+        uint64_t window;
+        ::memcpy(&window, bytes + pos / 8, sizeof(uint64_t));
+        return static_cast<uint32_t>((window >> (pos % 8)) & (~static_cast<uint64_t>(0) >> (64 - width)));
+    }
+
+    //number of leading elements whose 64 bit window stays inside the allocated blocks
+    size_t windowSafeCount() const
+    {
+        size_t storage_bytes = bits_.sizeBytes() * sizeof(Block);
+        if (storage_bytes < sizeof(uint64_t))
+        {
+            return 0;
+        }
+        size_t n = ((storage_bytes - sizeof(uint64_t)) * 8) / width() + 1;
+        return n < size_ ? n : size_;
+    }
+#endif
+
+public:
+    size_t size() const {return size_;};
+    bool empty() const {return size_ == 0;};
+    size_t bitWidth() const {return width();};
+    uint32_t maxValue() const {return static_cast<uint32_t>(~static_cast<uint64_t>(0) >> (64 - width()));};
+    size_t capacity() const {return bits_.capacity() / width();};
+
+    BitVector<Block, Allocator, allocPolicy>& bits() {return bits_;};
+    const BitVector<Block, Allocator, allocPolicy>& bits() const {return bits_;};
+
+    uint32_t get(size_t i) const
+    {
+        return aux::getBits(bits_.data(), i * width(), width());
+    }
+
+    //bits of x above the width are dropped
+    void set(size_t i, uint32_t x)
+    {
+        aux::setBits(bits_.data(), i * width(), width(), x);
+    }
+
+    uint32_t operator[](size_t i) const {return get(i);};
+    PackedReference<PackedVector> operator[](size_t i) {return PackedReference<PackedVector>(this, i);};
+
+    uint32_t front() const {return get(0);};
+    uint32_t back() const {return get(size_ - 1);};
+
+
+    bool reserve(size_t n)
+    {
+        return bits_.reserve(n * width());
+    }
+
+    bool resize(size_t n, uint32_t x = 0)
+    {
+        size_t old_size = size_;
+        if (!bits_.resize(n * width()))
+        {
+            return false;
+        }
+        size_ = n;
+        for (size_t i = old_size; i < n; i++)
+        {
+            set(i, x);
+        }
+        return true;
+    }
+
+    bool pushBack(uint32_t x)
+    {
+        size_t new_bits = (size_ + 1) * width();
+        if (bits_.capacity() < new_bits && !bits_.reserve(allocPolicy(new_bits)))
+        {
+            return false;
+        }
+        if (!bits_.resizeDefaultInit(new_bits))
+        {
+            return false;
+        }
+        set(size_, x);
+        size_++;
+        return true;
+    }
+
+    bool popBack()
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        size_--;
+        return bits_.resize(size_ * width());
+    }
+
+    void clear()
+    {
+        bits_.resize(0);
+        size_ = 0;
+    }
+
+
+    //copies n values starting at first to out
+    void unpack(uint32_t* out, size_t first, size_t n) const
+    {
+        size_t i = first;
+        const size_t end = first + n;
+#if !defined(ARDUINO)
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(bits_.data());
+        const size_t w = width();
+        size_t safe_end = windowSafeCount();
+        safe_end = safe_end < end ? safe_end : end;
+#if defined(__AVX2__)
+        //four windows per gather, shifted by their bit offsets and narrowed to 32 bits
+        const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(~static_cast<uint64_t>(0) >> (64 - w)));
+        const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+        const __m256i seven = _mm256_set1_epi64x(7);
+        for (; i + 4 <= safe_end; i += 4)
+        {
+            __m256i pos = _mm256_mul_epu32(_mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(i)), lanes), _mm256_set1_epi64x(static_cast<long long>(w)));
+            __m256i windows = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(bytes), _mm256_srli_epi64(pos, 3), 1);
+            __m256i values = _mm256_and_si256(_mm256_srlv_epi64(windows, _mm256_and_si256(pos, seven)), mask);
+            __m256i packed = _mm256_permutevar8x32_epi32(values, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i - first)), _mm256_castsi256_si128(packed));
+        }
+#endif
+        for (; i < safe_end; i++)
+        {
+            out[i - first] = loadWindow(bytes, i * w, w);
+        }
+#endif
+        for (; i < end; i++)
+        {
+            out[i - first] = get(i);
+        }
+    }
+
+    bool unpack(Vector<uint32_t>& out) const
+    {
+        if (!out.resizeDefaultInit(size_))
+        {
+            return false;
+        }
+        unpack(out.data(), 0, size_);
+        return true;
+    }
+
+    //appends n values, bits above the width are dropped
+    bool pack(const uint32_t* in, size_t n)
+    {
+        size_t pos = size_ * width();
+        if (!bits_.reserve(pos + n * width()) || !bits_.resizeDefaultInit(pos + n * width()))
+        {
+            return false;
+        }
+        size_t i = 0;
+#if !defined(ARDUINO)
+        //values are gathered in a 64 bit accumulator and leave it a byte at a time
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(bits_.data());
+        const size_t w = width();
+        const uint64_t mask = ~static_cast<uint64_t>(0) >> (64 - w);
+        uint8_t* out = bytes + pos / 8;
+        size_t n_acc = pos % 8;
+        uint64_t acc = n_acc == 0 ? 0 : *out & ((1u << n_acc) - 1);
+#if defined(__AVX2__)
+        //up to 14 bits four values are shifted into one group per step and the accumulator is stored 8 bytes at a time,
+        //bytes past the finished ones are rewritten by the next steps
+        if (w <= 14)
+        {
+            const uint8_t* storage_end = bytes + bits_.sizeBytes() * sizeof(Block);
+            const __m256i lane_mask = _mm256_set1_epi64x(static_cast<long long>(mask));
+            const __m256i shifts = _mm256_setr_epi64x(0, static_cast<long long>(w), static_cast<long long>(2 * w), static_cast<long long>(3 * w));
+            for (; i + 4 <= n && out + sizeof(uint64_t) <= storage_end; i += 4)
+            {
+                __m256i values = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+                values = _mm256_sllv_epi64(_mm256_and_si256(values, lane_mask), shifts);
+                __m128i halves = _mm_or_si128(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+                acc |= static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_or_si128(halves, _mm_unpackhi_epi64(halves, halves)))) << n_acc;
+                n_acc += 4 * w;
+                ::memcpy(out, &acc, sizeof(uint64_t));
+                out += n_acc / 8;
+                acc = acc >> (n_acc / 8 * 8);
+                n_acc = n_acc % 8;
+            }
+        }
+#endif
+        for (; i < n; i++)
+        {
+            acc |= (in[i] & mask) << n_acc;
+            n_acc += w;
+            while (n_acc >= 8)
+            {
+                *out++ = static_cast<uint8_t>(acc);
+                acc = acc >> 8;
+                n_acc -= 8;
+            }
+        }
+        if (n_acc != 0)
+        {
+            *out = static_cast<uint8_t>(acc);
+        }
+#endif
+        for (; i < n; i++)
+        {
+            set(size_ + i, in[i]);
+        }
+        size_ += n;
+        return true;
+    }
+
+    bool pack(const Vector<uint32_t>& in)
+    {
+        return pack(in.data(), in.size());
+    }
+
+
+    PackedVector()
+        :aux::PackedWidth<Bits>(), bits_(), size_(0) {};
+
+    //runtime width, only for PackedVector<0, ...>, clamped to 1 to 32 bits
+    explicit PackedVector(size_t width)
+        :aux::PackedWidth<Bits>(width), bits_(), size_(0)
+    {
+        static_assert(Bits == 0, "the width of PackedVector<Bits> is fixed at compile time");
+    }
+};
+
+
+template<size_t Bits, size_t N>
+using StaticPackedVector = PackedVector<Bits, uint8_t, FixedSizeAllocator<uint8_t, (N * Bits + 7) / 8>, allocationPolicyFixed>;
+
+}
+
+#endif
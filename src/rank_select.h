@@ -0,0 +1,228 @@
+#ifndef ASTL_RANK_SELECT_H
+#define ASTL_RANK_SELECT_H
+
+#include "bitvector.h"
+
+namespace astl
+{
+
+//immutable bit vector with a poppy style index (Zhou, Andersen, Kaminsky): per 2048 bit superblock a cumulative count
+//and the counts of its first three 512 bit subblocks packed in 10 bits each, 12 bytes per 256 on 64 bit hosts (~4.7%),
+//plus one sampled superblock per 8192 ones/zeros to start select
+template<class T, class Allocator = HeapAllocator<T>, AllocationPolicyFunc allocPolicy = allocationPolicy2>
+class RankSelectBitVector
+{
+public:
+    static const size_t SUPERBLOCK_BITS = 2048;
+    static const size_t SUBBLOCK_BITS = 512;
+    static const size_t SELECT_SAMPLE = 8192;
+
+    typedef BitVector<T, Allocator, allocPolicy> Bits;
+
+private:
+    static const size_t BLOCKS_IN_SUBBLOCK = SUBBLOCK_BITS / BitBlock<T>::BITS_IN_BLOCK;
+
+    Bits bits_;
+    Vector<size_t> ones_before_;//per superblock, one extra entry holds the total
+    Vector<uint32_t> subblock_counts_;
+    Vector<uint32_t> select1_samples_;
+    Vector<uint32_t> select0_samples_;
+
+    size_t numBlocks() const {return bits_.sizeBytes();};
+    size_t numSuperblocks() const {return subblock_counts_.size();};
+
+    static size_t subblockCount(uint32_t packed, size_t j) {return (packed >> (10 * j)) & 0x3FF;};
+
+    size_t zerosBefore(size_t superblock) const
+    {
+        return superblock * SUPERBLOCK_BITS - ones_before_[superblock];
+    }
+
+    void build()
+    {
+        const T* data = bits_.data();
+        const size_t n_blocks = numBlocks();
+        if (bits_.size() % BitBlock<T>::BITS_IN_BLOCK != 0)
+        {//the index counts whole blocks, so the padding past size() must be clear
+            bits_.data()[n_blocks - 1] &= aux::lowBitsMask<T>(bits_.size() % BitBlock<T>::BITS_IN_BLOCK);
+        }
+
+        const size_t n_superblocks = (bits_.size() + SUPERBLOCK_BITS - 1) / SUPERBLOCK_BITS;
+        ones_before_.resize(n_superblocks + 1);
+        subblock_counts_.resize(n_superblocks);
+        ones_before_[0] = 0;
+        for (size_t s = 0; s < n_superblocks; s++)
+        {
+            size_t total = 0;
+            uint32_t packed = 0;
+            for (size_t j = 0; j < 4; j++)
+            {
+                size_t first = (s * SUPERBLOCK_BITS + j * SUBBLOCK_BITS) / BitBlock<T>::BITS_IN_BLOCK;
+                size_t last = first + BLOCKS_IN_SUBBLOCK;
+                first = first < n_blocks ? first : n_blocks;
+                last = last < n_blocks ? last : n_blocks;
+                size_t count = aux::popcountBlocks(data + first, last - first);
+                if (j < 3)
+                {
+                    packed |= static_cast<uint32_t>(count) << (10 * j);
+                }
+                total += count;
+            }
+            subblock_counts_[s] = packed;
+            ones_before_[s + 1] = ones_before_[s] + total;
+        }
+
+        select1_samples_.clear();
+        select0_samples_.clear();
+        size_t next_one = 0;
+        size_t next_zero = 0;
+        for (size_t s = 0; s < n_superblocks; s++)
+        {
+            size_t bits_end = (s + 1) * SUPERBLOCK_BITS < bits_.size() ? (s + 1) * SUPERBLOCK_BITS : bits_.size();
+            for (; next_one < ones_before_[s + 1]; next_one += SELECT_SAMPLE)
+            {
+                select1_samples_.pushBack(static_cast<uint32_t>(s));
+            }
+            for (; next_zero < bits_end - ones_before_[s + 1]; next_zero += SELECT_SAMPLE)
+            {
+                select0_samples_.pushBack(static_cast<uint32_t>(s));
+            }
+        }
+    }
+
+    //last superblock in [lo, hi) whose preceding count is <= k
+    template<class Before>
+    size_t findSuperblock(size_t lo, size_t hi, size_t k, Before before) const
+    {
+        while (hi - lo > 1)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (before(mid) <= k)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    size_t selectInSuperblock(size_t s, size_t k, bool ones) const
+    {
+        uint32_t packed = subblock_counts_[s];
+        size_t j = 0;
+        for (; j < 3; j++)
+        {
+            size_t count = subblockCount(packed, j);
+            count = ones ? count : SUBBLOCK_BITS - count;
+            if (k < count)
+            {
+                break;
+            }
+            k -= count;
+        }
+        const T* data = bits_.data();
+        for (size_t b = (s * SUPERBLOCK_BITS + j * SUBBLOCK_BITS) / BitBlock<T>::BITS_IN_BLOCK; b < numBlocks(); b++)
+        {
+            T block = ones ? data[b] : static_cast<T>(~data[b]);
+            size_t count = aux::popcount(block);
+            if (k < count)
+            {
+                return b * BitBlock<T>::BITS_IN_BLOCK + aux::selectInBlock(block, k);
+            }
+            k -= count;
+        }
+        return bits_.size();
+    }
+
+public:
+    const Bits& bits() const {return bits_;};
+    size_t size() const {return bits_.size();};
+    size_t count() const {return ones_before_[numSuperblocks()];};
+    bool operator[](size_t pos) const {return bits_[pos];};
+
+    //bytes used by the index on top of the bits
+    size_t indexBytes() const
+    {
+        return ones_before_.size() * sizeof(size_t) + subblock_counts_.size() * sizeof(uint32_t) +
+            (select1_samples_.size() + select0_samples_.size()) * sizeof(uint32_t);
+    }
+
+    //number of set bits in [0, pos)
+    size_t rank1(size_t pos) const
+    {
+        if (pos >= bits_.size())
+        {
+            return count();
+        }
+        size_t s = pos / SUPERBLOCK_BITS;
+        size_t j = (pos % SUPERBLOCK_BITS) / SUBBLOCK_BITS;
+        size_t rank = ones_before_[s];
+        uint32_t packed = subblock_counts_[s];
+        for (size_t t = 0; t < j; t++)
+        {
+            rank += subblockCount(packed, t);
+        }
+        const T* data = bits_.data();
+        size_t first = (s * SUPERBLOCK_BITS + j * SUBBLOCK_BITS) / BitBlock<T>::BITS_IN_BLOCK;
+        size_t last = pos / BitBlock<T>::BITS_IN_BLOCK;
+        rank += aux::popcountBlocks(data + first, last - first);
+        if (pos % BitBlock<T>::BITS_IN_BLOCK != 0)
+        {
+            rank += aux::popcount(static_cast<T>(data[last] & aux::lowBitsMask<T>(pos % BitBlock<T>::BITS_IN_BLOCK)));
+        }
+        return rank;
+    }
+
+    size_t rank0(size_t pos) const
+    {
+        pos = pos < bits_.size() ? pos : bits_.size();
+        return pos - rank1(pos);
+    }
+
+    //position of the k-th (from 0) set bit, size() if there are not that many
+    size_t select1(size_t k) const
+    {
+        if (k >= count())
+        {
+            return bits_.size();
+        }
+        size_t sample = k / SELECT_SAMPLE;
+        size_t lo = select1_samples_[sample];
+        size_t hi = sample + 1 < select1_samples_.size() ? select1_samples_[sample + 1] + 1 : numSuperblocks();
+        const Vector<size_t>& ones_before = ones_before_;
+        size_t s = findSuperblock(lo, hi, k, [&](size_t i){return ones_before[i];});
+        return selectInSuperblock(s, k - ones_before_[s], true);
+    }
+
+    size_t select0(size_t k) const
+    {
+        if (k >= bits_.size() - count())
+        {
+            return bits_.size();
+        }
+        size_t sample = k / SELECT_SAMPLE;
+        size_t lo = select0_samples_[sample];
+        size_t hi = sample + 1 < select0_samples_.size() ? select0_samples_[sample + 1] + 1 : numSuperblocks();
+        size_t s = findSuperblock(lo, hi, k, [this](size_t i){return zerosBefore(i);});
+        return selectInSuperblock(s, k - zerosBefore(s), false);
+    }
+
+    RankSelectBitVector(const Bits& bits)
+        :bits_(bits)
+    {
+        build();
+    }
+
+    RankSelectBitVector(Bits&& bits)
+        :bits_(std::move(bits))
+    {
+        build();
+    }
+};
+
+}
+
+#endif
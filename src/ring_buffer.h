@@ -0,0 +1,248 @@
+#ifndef ASTL_RING_BUFFER_H
+#define ASTL_RING_BUFFER_H
+
+#include "allocator.h"
+#include "span.h"
+
+namespace astl
+{
+
+namespace aux
+{
+inline size_t roundUpPow2(size_t n)
+{
+    size_t out = 1;
+    while (out < n)
+    {
+        out = out << 1;
+    }
+    return out;
+}
+}
+
+
+//a ring region is contiguous up to the wrap point, so it splits into at most two spans
+template<class T>
+struct RingSegments
+{
+    Span<T> first;
+    Span<T> second;
+
+    size_t size() const {return first.size() + second.size();};
+};
+
+
+template<class T, class Allocator>
+class BasicRingBuffer
+{
+    T* data_;
+    Allocator allocator_;
+    size_t capacity_;
+    size_t head_;//free running read counter
+    size_t tail_;//free running write counter
+    bool overwrite_oldest_;
+
+    size_t index(size_t counter) const {return counter & (capacity_ - 1);};
+
+    RingSegments<T> segments(size_t start, size_t len) const
+    {
+        size_t first_len = capacity_ - index(start);
+        if (first_len >= len)
+        {
+            return {Span<T>(data_ + index(start), len), Span<T>()};
+        }
+        return {Span<T>(data_ + index(start), first_len), Span<T>(data_, len - first_len)};
+    }
+
+protected:
+    BasicRingBuffer(size_t capacity)
+        :data_(nullptr), allocator_(), capacity_(0), head_(0), tail_(0), overwrite_oldest_(false)
+    {
+        data_ = allocator_.allocate(capacity);
+        if (data_ != nullptr)
+        {
+            capacity_ = capacity;
+        }
+    }
+
+public:
+    size_t size() const {return tail_ - head_;};
+    size_t capacity() const {return capacity_;};
+    size_t available() const {return capacity_ - size();};
+    bool empty() const {return tail_ == head_;};
+    bool full() const {return size() == capacity_;};
+
+    //when set, pushing into a full buffer drops the oldest elements instead of failing
+    void setOverwriteOldest(bool overwrite) {overwrite_oldest_ = overwrite;};
+    bool overwriteOldest() const {return overwrite_oldest_;};
+
+    template<class ...Args>
+    bool emplace(Args&&... args)
+    {
+        if (full())
+        {
+            if (!overwrite_oldest_ || capacity_ == 0)
+            {
+                return false;
+            }
+            pop();
+        }
+        new (data_ + index(tail_)) T(std::forward<Args>(args)...);
+        tail_++;
+        return true;
+    }
+
+
+    bool push(const T& x)
+    {
+        return emplace(x);
+    }
+
+
+    bool pop()
+    {
+        if (empty())
+        {
+            return false;
+        }
+        data_[index(head_)].~T();
+        head_++;
+        return true;
+    }
+
+
+    bool pop(T& x)
+    {
+        if (empty())
+        {
+            return false;
+        }
+        x = std::move(data_[index(head_)]);
+        return pop();
+    }
+
+    T& peek() {return data_[index(head_)];};
+    const T& peek() const {return data_[index(head_)];};
+    T& operator[](size_t i) {return data_[index(head_ + i)];};
+    const T& operator[](size_t i) const {return data_[index(head_ + i)];};
+
+
+    size_t write(Span<const T> x)
+    {
+        size_t len = x.size();
+        if (len > available())
+        {
+            if (!overwrite_oldest_)
+            {
+                len = available();
+            }
+            else
+            {
+                if (len > capacity_)
+                {
+                    x = x.subspan(len - capacity_, capacity_);
+                    len = capacity_;
+                }
+                consume(len - available());
+            }
+        }
+
+        RingSegments<T> free_segments = segments(tail_, len);
+        mem_init_copy(free_segments.first.data(), x.data(), free_segments.first.size());
+        mem_init_copy(free_segments.second.data(), x.data() + free_segments.first.size(), free_segments.second.size());
+        tail_ += len;
+        return len;
+    }
+
+
+    size_t read(Span<T> x)
+    {
+        size_t len = x.size() < size() ? x.size() : size();
+        RingSegments<T> used_segments = segments(head_, len);
+        for (size_t i = 0; i < used_segments.first.size(); i++)
+        {
+            x[i] = std::move(used_segments.first[i]);
+        }
+        for (size_t i = 0; i < used_segments.second.size(); i++)
+        {
+            x[used_segments.first.size() + i] = std::move(used_segments.second[i]);
+        }
+        consume(len);
+        return len;
+    }
+
+    //zero copy access to the stored elements, release them with consume()
+    RingSegments<T> readSegments() const {return segments(head_, size());};
+
+    bool consume(size_t n)
+    {
+        if (n > size())
+        {
+            return false;
+        }
+        RingSegments<T> used_segments = segments(head_, n);
+        memclear(used_segments.first.data(), used_segments.first.size());
+        memclear(used_segments.second.data(), used_segments.second.size());
+        head_ += n;
+        return true;
+    }
+
+    //zero copy access to the free space (e.g. as a DMA target), publish written elements with produce()
+    template<class X = T>
+    RingSegments<T> writeSegments() const
+    {
+        static_assert(std::is_trivially_constructible<X>::value, "writeSegments requires a trivial type");
+        return segments(tail_, available());
+    }
+
+    bool produce(size_t n)
+    {
+        if (n > available())
+        {
+            return false;
+        }
+        tail_ += n;
+        return true;
+    }
+
+
+    void clear()
+    {
+        consume(size());
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    BasicRingBuffer(const BasicRingBuffer&) = delete;
+    BasicRingBuffer& operator=(const BasicRingBuffer&) = delete;
+
+    ~BasicRingBuffer()
+    {
+        clear();
+        allocator_.deallocate(data_, capacity_);
+    }
+};
+
+
+template<class T, size_t N>
+class RingBuffer: public BasicRingBuffer<T, FixedSizeAllocator<T, N>>
+{
+    static_assert(N != 0 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of two");
+public:
+    RingBuffer()
+        :BasicRingBuffer<T, FixedSizeAllocator<T, N>>(N) {};
+};
+
+
+template<class T, class Allocator = HeapAllocator<T>>
+class DynamicRingBuffer: public BasicRingBuffer<T, Allocator>
+{
+public:
+    //capacity is rounded up to the next power of two
+    DynamicRingBuffer(size_t min_capacity)
+        :BasicRingBuffer<T, Allocator>(aux::roundUpPow2(min_capacity)) {};
+};
+
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef ASTL_SOA_VECTOR_H
+#define ASTL_SOA_VECTOR_H
+
+#include "vector.h"
+#include "span.h"
+
+namespace astl
+{
+
+namespace aux
+{
+
+template<size_t I, class T, class ...Ts>
+struct TypeAt
+{
+    typedef typename TypeAt<I - 1, Ts...>::type type;
+};
+
+template<class T, class ...Ts>
+struct TypeAt<0, T, Ts...>
+{
+    typedef T type;
+};
+
+
+template<template<class> class Allocator, class ...Ts>
+struct SoAColumns
+{
+    bool reserve(size_t) {return true;};
+    bool resize(size_t, size_t) {return true;};
+    void emplaceBack() {};
+    void erase(size_t, size_t) {};
+    void popBack() {};
+    void clear() {};
+};
+
+
+template<template<class> class Allocator, class T, class ...Ts>
+struct SoAColumns<Allocator, T, Ts...>
+{
+    Vector<T, Allocator<T>, allocationPolicyFixed> column;
+    SoAColumns<Allocator, Ts...> rest;
+
+    bool reserve(size_t new_capacity)
+    {
+        return column.reserve(new_capacity) && rest.reserve(new_capacity);
+    }
+
+    //a column that fails leaves the ones before it back at old_size, capacity is reserved up front so that cannot fail
+    bool resize(size_t new_size, size_t old_size)
+    {
+        if (!column.resize(new_size))
+        {
+            return false;
+        }
+        if (!rest.resize(new_size, old_size))
+        {
+            column.resize(old_size);
+            return false;
+        }
+        return true;
+    }
+
+    template<class X, class ...Xs>
+    void emplaceBack(X&& x, Xs&&... xs)
+    {
+        column.emplaceBack(std::forward<X>(x));
+        rest.emplaceBack(std::forward<Xs>(xs)...);
+    }
+
+    void erase(size_t start, size_t end)
+    {
+        column.erase(start, end);
+        rest.erase(start, end);
+    }
+
+    void popBack()
+    {
+        column.popBack();
+        rest.popBack();
+    }
+
+    void clear()
+    {
+        column.clear();
+        rest.clear();
+    }
+};
+
+
+template<size_t I, class Columns>
+struct SoAColumnAt
+{
+    typedef typename SoAColumnAt<I - 1, decltype(Columns::rest)>::type type;
+    static type& get(Columns& c) {return SoAColumnAt<I - 1, decltype(Columns::rest)>::get(c.rest);};
+    static const type& get(const Columns& c) {return SoAColumnAt<I - 1, decltype(Columns::rest)>::get(c.rest);};
+};
+
+template<class Columns>
+struct SoAColumnAt<0, Columns>
+{
+    typedef decltype(Columns::column) type;
+    static type& get(Columns& c) {return c.column;};
+    static const type& get(const Columns& c) {return c.column;};
+};
+
+}
+
+
+template<class SoA>
+class SoARow
+{
+    SoA* soa_;
+    size_t pos_;
+
+public:
+    template<size_t I>
+    auto get() const -> decltype(soa_->template data<I>()[0]) {return soa_->template data<I>()[pos_];};
+
+    size_t index() const {return pos_;};
+
+    SoARow(SoA* soa, size_t pos)
+        :soa_(soa), pos_(pos) {};
+};
+
+
+template<template<class> class Allocator, AllocationPolicyFunc allocPolicy, class ...Ts>
+class BasicSoAVector
+{
+    typedef aux::SoAColumns<Allocator, Ts...> Columns;
+
+    Columns columns_;
+    size_t size_;
+    size_t capacity_;
+
+public:
+    template<size_t I>
+    using ColumnType = typename aux::TypeAt<I, Ts...>::type;
+
+    static constexpr size_t num_columns = sizeof...(Ts);
+
+    size_t size() const {return size_;};
+    size_t capacity() const {return capacity_;};
+
+    bool reserve(size_t new_capacity)
+    {
+        if (new_capacity <= capacity_)
+        {
+            return true;
+        }
+        if (!columns_.reserve(new_capacity))
+        {
+            return false;
+        }
+        capacity_ = new_capacity;
+        return true;
+    }
+
+
+    bool resize(size_t new_size)
+    {
+        if (!reserve(new_size) || !columns_.resize(new_size, size_))
+        {
+            return false;
+        }
+        size_ = new_size;
+        return true;
+    }
+
+
+    template<class ...Args>
+    bool emplaceBack(Args&&... args)
+    {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "emplaceBack takes one value per column");
+        if (capacity_ == size_ && !reserve(allocPolicy(size_ + 1)))
+        {
+            return false;
+        }
+        columns_.emplaceBack(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+
+    bool pushBack(const Ts&... ts)
+    {
+        return emplaceBack(ts...);
+    }
+
+
+    bool erase(size_t start, size_t end)
+    {
+        if (end > size_)
+        {
+            return false;
+        }
+        if (start >= end)
+        {
+            return true;
+        }
+        columns_.erase(start, end);
+        size_ -= end - start;
+        return true;
+    }
+
+
+    bool erase(size_t pos)
+    {
+        return erase(pos, pos + 1);
+    }
+
+
+    bool popBack()
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        columns_.popBack();
+        size_--;
+        return true;
+    }
+
+
+    void clear()
+    {
+        columns_.clear();
+        size_ = 0;
+    }
+
+    //contiguous unit stride view of a single field
+    template<size_t I>
+    Span<ColumnType<I>> data() {return Span<ColumnType<I>>(aux::SoAColumnAt<I, Columns>::get(columns_).data(), size_);};
+    template<size_t I>
+    Span<const ColumnType<I>> data() const {return Span<const ColumnType<I>>(aux::SoAColumnAt<I, Columns>::get(columns_).data(), size_);};
+
+    template<size_t I>
+    ColumnType<I>& get(size_t pos) {return aux::SoAColumnAt<I, Columns>::get(columns_)[pos];};
+    template<size_t I>
+    const ColumnType<I>& get(size_t pos) const {return aux::SoAColumnAt<I, Columns>::get(columns_)[pos];};
+
+    SoARow<BasicSoAVector> operator[](size_t pos) {return SoARow<BasicSoAVector>(this, pos);};
+    SoARow<const BasicSoAVector> operator[](size_t pos) const {return SoARow<const BasicSoAVector>(this, pos);};
+
+    BasicSoAVector()
+        :columns_(), size_(0), capacity_(0) {};
+
+    BasicSoAVector(size_t len)
+        :BasicSoAVector()
+    {
+        resize(len);
+    }
+};
+
+
+template<class ...Ts>
+using SoAVector = BasicSoAVector<HeapAllocator, allocationPolicy2, Ts...>;
+
+namespace aux
+{
+template<size_t N>
+struct FixedSizeAllocatorOf
+{
+    template<class T>
+    using type = FixedSizeAllocator<T, N>;
+};
+}
+
+template<size_t N, class ...Ts>
+using StaticSoAVector = BasicSoAVector<aux::FixedSizeAllocatorOf<N>::template type, allocationPolicyFixed, Ts...>;
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef ASTL_SPAN_H
+#define ASTL_SPAN_H
+
+#include "memory_operations.h"
+
+namespace astl
+{
+
+template <class T>
+class Span
+{
+    T* data_;
+    size_t size_;
+
+public:
+    size_t size() const {return size_;};
+    bool empty() const {return size_ == 0;};
+
+    T& operator[](size_t i) const {return data_[i];};
+    T* data() const {return data_;};
+
+    Span<T> subspan(size_t offset, size_t len) const {return Span<T>(data_ + offset, len);};
+
+    Span()
+        :data_(nullptr), size_(0) {};
+    Span(T* data, size_t size)
+        :data_(data), size_(size) {};
+
+    operator Span<const T>() const {return Span<const T>(data_, size_);};
+
+    typedef T* iterator;
+    iterator begin() const {return data_;};
+    iterator end() const {return data_ + size_;};
+};
+
+}
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef ASTL_SPSC_QUEUE_H
+#define ASTL_SPSC_QUEUE_H
+
+#include "memory_operations.h"
+
+#if !defined(ARDUINO)
+#include <atomic>
+#endif
+
+namespace astl
+{
+
+namespace aux
+{
+
+#if defined(ARDUINO)
+//single byte loads and stores are atomic on AVR, ordering against the slot data only needs a compiler barrier
+typedef uint8_t spsc_index_type;
+static const size_t SPSC_ALIGNMENT = 1;
+
+class SpscCounter
+{
+    volatile spsc_index_type value_;
+public:
+    spsc_index_type loadRelaxed() const {return value_;};
+    spsc_index_type loadAcquire() const
+    {
+        spsc_index_type value = value_;
+        __asm__ __volatile__("" ::: "memory");
+        return value;
+    }
+    void storeRelease(spsc_index_type value)
+    {
+        __asm__ __volatile__("" ::: "memory");
+        value_ = value;
+    }
+    SpscCounter()
+        :value_(0) {};
+};
+#else
+typedef size_t spsc_index_type;
+static const size_t SPSC_ALIGNMENT = 64;//keeps producer and consumer state on separate cache lines
+
+class SpscCounter
+{
+    std::atomic<spsc_index_type> value_;
+public:
+    spsc_index_type loadRelaxed() const {return value_.load(std::memory_order_relaxed);};
+    spsc_index_type loadAcquire() const {return value_.load(std::memory_order_acquire);};
+    void storeRelease(spsc_index_type value) {value_.store(value, std::memory_order_release);};
+    SpscCounter()
+        :value_(0) {};
+};
+#endif
+
+}
+
+
+//wait free queue between exactly one producer (e.g. an ISR) and one consumer (e.g. the main loop)
+template<class T, size_t N>
+class SpscQueue
+{
+    static_assert(N != 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+    static_assert(N <= (static_cast<aux::spsc_index_type>(~static_cast<aux::spsc_index_type>(0)) >> 1) + 1, "SpscQueue capacity must fit the index type");
+
+    typedef aux::spsc_index_type index_type;
+
+    alignas(aux::SPSC_ALIGNMENT) aux::SpscCounter tail_;
+    index_type cached_head_;//producer's last view of head_
+
+    alignas(aux::SPSC_ALIGNMENT) aux::SpscCounter head_;
+    index_type cached_tail_;//consumer's last view of tail_
+
+    alignas(aux::SPSC_ALIGNMENT) alignas(T) uint8_t data_[N * sizeof(T)];
+
+    T* slot(index_type counter) {return reinterpret_cast<T*>(data_) + (counter & (N - 1));};
+
+    size_t freeSlots(index_type tail)
+    {
+        size_t n_free = N - static_cast<index_type>(tail - cached_head_);
+        if (n_free == 0)
+        {
+            cached_head_ = head_.loadAcquire();
+            n_free = N - static_cast<index_type>(tail - cached_head_);
+        }
+        return n_free;
+    }
+
+    size_t usedSlots(index_type head)
+    {
+        size_t n_used = static_cast<index_type>(cached_tail_ - head);
+        if (n_used == 0)
+        {
+            cached_tail_ = tail_.loadAcquire();
+            n_used = static_cast<index_type>(cached_tail_ - head);
+        }
+        return n_used;
+    }
+
+public:
+    constexpr size_t capacity() const {return N;};
+
+    //approximate when called concurrently with the other side
+    size_t size() const {return static_cast<index_type>(tail_.loadAcquire() - head_.loadAcquire());};
+    bool empty() const {return size() == 0;};
+
+    //producer side
+    template<class ...Args>
+    bool tryEmplace(Args&&... args)
+    {
+        index_type tail = tail_.loadRelaxed();
+        if (freeSlots(tail) == 0)
+        {
+            return false;
+        }
+        new (slot(tail)) T(std::forward<Args>(args)...);
+        tail_.storeRelease(tail + 1);
+        return true;
+    }
+
+
+    bool tryPush(const T& x)
+    {
+        return tryEmplace(x);
+    }
+
+
+    size_t pushN(const T* x, size_t n)
+    {
+        index_type tail = tail_.loadRelaxed();
+        size_t n_free = freeSlots(tail);
+        if (n_free < n)
+        {
+            cached_head_ = head_.loadAcquire();
+            n_free = N - static_cast<index_type>(tail - cached_head_);
+        }
+        n = n < n_free ? n : n_free;
+
+        size_t first_len = N - (tail & (N - 1));
+        first_len = first_len < n ? first_len : n;
+        mem_init_copy(slot(tail), x, first_len);
+        mem_init_copy(slot(tail + first_len), x + first_len, n - first_len);
+        tail_.storeRelease(tail + n);
+        return n;
+    }
+
+
+    //consumer side
+    bool tryPop(T& x)
+    {
+        index_type head = head_.loadRelaxed();
+        if (usedSlots(head) == 0)
+        {
+            return false;
+        }
+        T* ptr = slot(head);
+        x = std::move(*ptr);
+        ptr->~T();
+        head_.storeRelease(head + 1);
+        return true;
+    }
+
+
+    size_t popN(T* x, size_t n)
+    {
+        index_type head = head_.loadRelaxed();
+        size_t n_used = usedSlots(head);
+        if (n_used < n)
+        {
+            cached_tail_ = tail_.loadAcquire();
+            n_used = static_cast<index_type>(cached_tail_ - head);
+        }
+        n = n < n_used ? n : n_used;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            T* ptr = slot(head + i);
+            x[i] = std::move(*ptr);
+            ptr->~T();
+        }
+        head_.storeRelease(head + n);
+        return n;
+    }
+
+
+    SpscQueue()
+        :cached_head_(0), cached_tail_(0) {};
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue()
+    {
+        index_type head = head_.loadRelaxed();
+        index_type tail = tail_.loadRelaxed();
+        for (; head != tail; head++)
+        {
+            slot(head)->~T();
+        }
+    }
+};
+
+}
+
+#endif
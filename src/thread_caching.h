@@ -0,0 +1,391 @@
+#ifndef ASTL_THREAD_CACHING_H
+#define ASTL_THREAD_CACHING_H
+
+#include "memory_operations.h"
+
+#if !defined(ARDUINO)
+#include <mutex>
+
+namespace astl
+{
+
+namespace aux
+{
+struct CachedBlock
+{
+    CachedBlock* next;
+};
+
+
+//shared pool behind every thread cache, one lock per size class so threads only meet when a batch moves
+class CentralFreeLists
+{
+public:
+    static const size_t MIN_CLASS_SIZE = 16;
+    static const size_t N_CLASSES = 9;
+    static const size_t MAX_CLASS_SIZE = MIN_CLASS_SIZE << (N_CLASSES - 1);
+    static const size_t CHUNK_BYTES = 64 * 1024;
+
+    static size_t classIndex(size_t n_bytes)
+    {
+        size_t index = 0;
+        size_t class_size = MIN_CLASS_SIZE;
+        while (class_size < n_bytes)
+        {
+            class_size = class_size << 1;
+            index++;
+        }
+        return index;
+    }
+
+    static size_t classSize(size_t index) {return MIN_CLASS_SIZE << index;};
+
+    //blocks moved per refill or release, about 8KB worth but never fewer than 2 or more than 32
+    static size_t batchSize(size_t index)
+    {
+        size_t n = 8192 / classSize(index);
+        return n < 2 ? 2 : (n > 32 ? 32 : n);
+    }
+
+    //returns a chain of up to batchSize(index) blocks ending in nullptr
+    CachedBlock* fetch(size_t index, size_t& n_fetched)
+    {
+        ClassList& list = lists_[index];
+        size_t batch = batchSize(index);
+        {
+            std::lock_guard<std::mutex> lock(list.mutex);
+            if (list.head != nullptr)
+            {
+                CachedBlock* first = list.head;
+                CachedBlock* last = first;
+                n_fetched = 1;
+                while (n_fetched < batch && last->next != nullptr)
+                {
+                    last = last->next;
+                    n_fetched++;
+                }
+                list.head = last->next;
+                list.length -= n_fetched;
+                last->next = nullptr;
+                return first;
+            }
+        }
+        return carve(index, batch, n_fetched);
+    }
+
+    void release(size_t index, CachedBlock* first, CachedBlock* last, size_t n)
+    {
+        ClassList& list = lists_[index];
+        std::lock_guard<std::mutex> lock(list.mutex);
+        last->next = list.head;
+        list.head = first;
+        list.length += n;
+    }
+
+    //single block paths for threads whose cache is already gone
+    void* allocateOne(size_t index)
+    {
+        size_t n_fetched;
+        CachedBlock* first = fetch(index, n_fetched);
+        if (n_fetched > 1)
+        {
+            CachedBlock* last = first->next;
+            while (last->next != nullptr)
+            {
+                last = last->next;
+            }
+            release(index, first->next, last, n_fetched - 1);
+        }
+        return first;
+    }
+
+    void deallocateOne(size_t index, void* ptr)
+    {
+        CachedBlock* block = static_cast<CachedBlock*>(ptr);
+        release(index, block, block, 1);
+    }
+
+    size_t reservedBytes()
+    {
+        std::lock_guard<std::mutex> lock(chunk_mutex_);
+        return reserved_bytes_;
+    }
+
+    //never destroyed, thread caches may still flush into it while statics are torn down
+    static CentralFreeLists& instance()
+    {
+        static CentralFreeLists* central = new CentralFreeLists();
+        return *central;
+    }
+
+private:
+    struct alignas(64) ClassList
+    {
+        std::mutex mutex;
+        CachedBlock* head;
+        size_t length;
+    };
+
+    ClassList lists_[N_CLASSES];
+    std::mutex chunk_mutex_;
+    uint8_t* chunk_top_;
+    uint8_t* chunk_end_;
+    size_t reserved_bytes_;
+
+    CentralFreeLists()
+        :chunk_top_(nullptr), chunk_end_(nullptr), reserved_bytes_(0)
+    {
+        for (size_t i = 0; i < N_CLASSES; i++)
+        {
+            lists_[i].head = nullptr;
+            lists_[i].length = 0;
+        }
+    }
+
+    //the tail of a chunk too short for the next batch is split into the largest classes that fit it and handed to their
+    //lists, called with chunk_mutex_ held, which is always taken before a list mutex
+    void recycleRemainder()
+    {
+        for (size_t index = N_CLASSES; index-- > 0; )
+        {
+            while (static_cast<size_t>(chunk_end_ - chunk_top_) >= classSize(index))
+            {
+                CachedBlock* block = reinterpret_cast<CachedBlock*>(chunk_top_);
+                chunk_top_ += classSize(index);
+                release(index, block, block, 1);
+            }
+        }
+    }
+
+    //fresh blocks come from large chunks that are kept for the life of the process
+    CachedBlock* carve(size_t index, size_t batch, size_t& n_fetched)
+    {
+        size_t size = classSize(index);
+        uint8_t* ptr;
+        {
+            std::lock_guard<std::mutex> lock(chunk_mutex_);
+            if (static_cast<size_t>(chunk_end_ - chunk_top_) < size * batch)
+            {
+                recycleRemainder();
+                chunk_top_ = new uint8_t[CHUNK_BYTES];
+                chunk_end_ = chunk_top_ + CHUNK_BYTES;
+                reserved_bytes_ += CHUNK_BYTES;
+            }
+            ptr = chunk_top_;
+            chunk_top_ += size * batch;
+        }
+        for (size_t i = 0; i + 1 < batch; i++)
+        {
+            reinterpret_cast<CachedBlock*>(ptr + i * size)->next = reinterpret_cast<CachedBlock*>(ptr + (i + 1) * size);
+        }
+        reinterpret_cast<CachedBlock*>(ptr + (batch - 1) * size)->next = nullptr;
+        n_fetched = batch;
+        return reinterpret_cast<CachedBlock*>(ptr);
+    }
+};
+
+
+//per thread free lists, a block freed by another thread simply joins the cache of the thread that frees it
+class ThreadCache
+{
+    struct FreeList
+    {
+        CachedBlock* head;
+        size_t length;
+    };
+
+    FreeList lists_[CentralFreeLists::N_CLASSES];
+
+    //plain thread_local flag without a destructor, it stays readable while the other thread_locals are torn down
+    static bool& destroyed()
+    {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    void releaseBatch(size_t index, size_t n)
+    {
+        FreeList& list = lists_[index];
+        CachedBlock* first = list.head;
+        CachedBlock* last = first;
+        for (size_t i = 1; i < n; i++)
+        {
+            last = last->next;
+        }
+        list.head = last->next;
+        list.length -= n;
+        CentralFreeLists::instance().release(index, first, last, n);
+    }
+
+public:
+    void* allocate(size_t index)
+    {
+        FreeList& list = lists_[index];
+        if (list.head == nullptr)
+        {
+            size_t n_fetched;
+            list.head = CentralFreeLists::instance().fetch(index, n_fetched);
+            list.length = n_fetched;
+        }
+        CachedBlock* block = list.head;
+        list.head = block->next;
+        list.length--;
+        return block;
+    }
+
+    void deallocate(size_t index, void* ptr)
+    {
+        FreeList& list = lists_[index];
+        CachedBlock* block = static_cast<CachedBlock*>(ptr);
+        block->next = list.head;
+        list.head = block;
+        list.length++;
+        size_t batch = CentralFreeLists::batchSize(index);
+        if (list.length > 2 * batch)
+        {
+            releaseBatch(index, batch);
+        }
+    }
+
+    void flush()
+    {
+        for (size_t i = 0; i < CentralFreeLists::N_CLASSES; i++)
+        {
+            if (lists_[i].length != 0)
+            {
+                releaseBatch(i, lists_[i].length);
+            }
+        }
+    }
+
+    ThreadCache()
+    {
+        for (size_t i = 0; i < CentralFreeLists::N_CLASSES; i++)
+        {
+            lists_[i].head = nullptr;
+            lists_[i].length = 0;
+        }
+    }
+
+    ~ThreadCache()
+    {
+        flush();
+        destroyed() = true;
+    }
+
+    //nullptr once this thread's cache has been destroyed, e.g. for containers freed by later thread_local destructors,
+    //callers then go straight to the central lists
+    static ThreadCache* local()
+    {
+        if (destroyed())
+        {
+            return nullptr;
+        }
+        static thread_local ThreadCache cache;
+        return &cache;
+    }
+};
+
+
+inline void* threadCachedAllocate(size_t n_bytes)
+{
+    if (n_bytes > CentralFreeLists::MAX_CLASS_SIZE)
+    {
+        return new uint8_t[n_bytes];
+    }
+    size_t index = CentralFreeLists::classIndex(n_bytes);
+    ThreadCache* cache = ThreadCache::local();
+    return cache != nullptr ? cache->allocate(index) : CentralFreeLists::instance().allocateOne(index);
+}
+
+inline void threadCachedDeallocate(void* ptr, size_t n_bytes)
+{
+    if (n_bytes > CentralFreeLists::MAX_CLASS_SIZE)
+    {
+        delete[] static_cast<uint8_t*>(ptr);
+        return;
+    }
+    size_t index = CentralFreeLists::classIndex(n_bytes);
+    ThreadCache* cache = ThreadCache::local();
+    if (cache != nullptr)
+    {
+        cache->deallocate(index, ptr);
+    }
+    else
+    {
+        CentralFreeLists::instance().deallocateOne(index, ptr);
+    }
+}
+}
+
+
+template<class T>
+class ThreadCachingAllocator
+{
+public:
+    static const bool is_movable = true;
+    constexpr size_t maxSize() const {return (size_t(1) << 30)/sizeof(T);};
+
+    T* allocate(size_t n)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        return static_cast<T*>(aux::threadCachedAllocate(n * sizeof(T)));
+    }
+
+    bool deallocate(T* ptr, size_t n)
+    {
+        if (ptr != nullptr && n != 0)
+        {
+            aux::threadCachedDeallocate(ptr, n * sizeof(T));
+        }
+        return true;
+    }
+
+    //a block can grow up to the size of its class without moving
+    bool tryExpand(T* ptr, size_t old_n, size_t new_n)
+    {
+        size_t old_bytes = old_n * sizeof(T);
+        size_t new_bytes = new_n * sizeof(T);
+        return old_bytes <= aux::CentralFreeLists::MAX_CLASS_SIZE && new_bytes <= aux::CentralFreeLists::MAX_CLASS_SIZE &&
+            aux::CentralFreeLists::classIndex(old_bytes) == aux::CentralFreeLists::classIndex(new_bytes);
+    }
+
+    ThreadCachingAllocator() {};
+};
+
+
+template<class T>
+class ThreadCachingArena
+{
+public:
+    static const bool is_movable = true;
+    static const bool is_monotonic = false;
+
+    ThreadCachingArena() {};
+
+    template <class ...Args>
+    T* create(Args&&... args)
+    {
+        return new (aux::threadCachedAllocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    bool destroy(T* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+        ptr->~T();
+        aux::threadCachedDeallocate(ptr, sizeof(T));
+        return true;
+    }
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,419 @@
+#ifndef ASTL_TLSF_H
+#define ASTL_TLSF_H
+
+#include "bit_operations.h"
+
+namespace astl
+{
+
+namespace aux
+{
+#if defined(ARDUINO)
+static const size_t TLSF_SL_INDEX_COUNT_LOG2 = 3;
+static const size_t TLSF_FL_INDEX_MAX = 16;
+#else
+static const size_t TLSF_SL_INDEX_COUNT_LOG2 = 4;
+static const size_t TLSF_FL_INDEX_MAX = 32;
+#endif
+}
+
+
+//Two-Level Segregated Fit allocator over a caller supplied region, allocation and release are O(1)
+class TlsfResource
+{
+    struct Block
+    {
+        Block* prev_phys;//only valid when the previous block is free
+        size_t size;//payload size, the low bits hold the FREE and PREV_FREE flags
+        //free blocks keep their list links in the payload
+        Block* next_free;
+        Block* prev_free;
+    };
+
+    //the two flag bits live in the low bits of size, so sizes are kept multiples of at least 4 even with 2 byte pointers
+    static const size_t ALIGN = sizeof(void*) > 4 ? sizeof(void*) : 4;
+    static const size_t HEADER_SIZE = sizeof(Block*) + sizeof(size_t);
+    static const size_t MIN_BLOCK_SIZE = 2 * sizeof(Block*);
+
+    static const size_t FREE_BIT = 1;
+    static const size_t PREV_FREE_BIT = 2;
+    static const size_t FLAG_BITS = FREE_BIT | PREV_FREE_BIT;
+
+    static const size_t SL_INDEX_COUNT_LOG2 = aux::TLSF_SL_INDEX_COUNT_LOG2;
+    static const size_t SL_INDEX_COUNT = static_cast<size_t>(1) << SL_INDEX_COUNT_LOG2;
+    static const size_t ALIGN_LOG2 = ALIGN == 8 ? 3 : 2;
+    static const size_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_LOG2;
+    static const size_t FL_INDEX_COUNT = aux::TLSF_FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+    static const size_t SMALL_BLOCK_SIZE = static_cast<size_t>(1) << FL_INDEX_SHIFT;
+
+    size_t fl_bitmap_;
+    size_t sl_bitmap_[FL_INDEX_COUNT];
+    Block* blocks_[FL_INDEX_COUNT][SL_INDEX_COUNT];
+    size_t free_bytes_;
+    size_t total_bytes_;
+
+    static size_t blockSize(const Block* block) {return block->size & ~FLAG_BITS;};
+    static bool isFree(const Block* block) {return (block->size & FREE_BIT) != 0;};
+    static bool isPrevFree(const Block* block) {return (block->size & PREV_FREE_BIT) != 0;};
+    static void setSize(Block* block, size_t size) {block->size = size | (block->size & FLAG_BITS);};
+    static void setFree(Block* block, bool free) {block->size = free ? (block->size | FREE_BIT) : (block->size & ~FREE_BIT);};
+    static void setPrevFree(Block* block, bool free) {block->size = free ? (block->size | PREV_FREE_BIT) : (block->size & ~PREV_FREE_BIT);};
+
+    static void* payload(Block* block) {return reinterpret_cast<uint8_t*>(block) + HEADER_SIZE;};
+    static Block* fromPayload(void* ptr) {return reinterpret_cast<Block*>(static_cast<uint8_t*>(ptr) - HEADER_SIZE);};
+    static Block* nextPhys(Block* block) {return reinterpret_cast<Block*>(static_cast<uint8_t*>(payload(block)) + blockSize(block));};
+
+    static size_t alignUp(size_t n) {return (n + ALIGN - 1) & ~(ALIGN - 1);};
+
+    static bool mapping(size_t size, size_t& fl, size_t& sl)
+    {
+        if (size < SMALL_BLOCK_SIZE)
+        {
+            fl = 0;
+            sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+            return true;
+        }
+        size_t f = aux::findLastSet(size);
+        sl = (size >> (f - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        fl = f - (FL_INDEX_SHIFT - 1);
+        return fl < FL_INDEX_COUNT;
+    }
+
+    //rounds the request up so that any block of the found list fits it
+    static bool mappingSearch(size_t size, size_t& fl, size_t& sl)
+    {
+        if (size >= SMALL_BLOCK_SIZE)
+        {
+            size_t round = (static_cast<size_t>(1) << (aux::findLastSet(size) - SL_INDEX_COUNT_LOG2)) - 1;
+            if (size + round < size)
+            {
+                return false;
+            }
+            size += round;
+        }
+        return mapping(size, fl, sl);
+    }
+
+    void insertFree(Block* block)
+    {
+        size_t fl, sl;
+        mapping(blockSize(block), fl, sl);
+        block->prev_free = nullptr;
+        block->next_free = blocks_[fl][sl];
+        if (block->next_free != nullptr)
+        {
+            block->next_free->prev_free = block;
+        }
+        blocks_[fl][sl] = block;
+        fl_bitmap_ |= static_cast<size_t>(1) << fl;
+        sl_bitmap_[fl] |= static_cast<size_t>(1) << sl;
+    }
+
+    void removeFree(Block* block)
+    {
+        size_t fl, sl;
+        mapping(blockSize(block), fl, sl);
+        if (block->prev_free != nullptr)
+        {
+            block->prev_free->next_free = block->next_free;
+        }
+        else
+        {
+            blocks_[fl][sl] = block->next_free;
+        }
+        if (block->next_free != nullptr)
+        {
+            block->next_free->prev_free = block->prev_free;
+        }
+        if (blocks_[fl][sl] == nullptr)
+        {
+            sl_bitmap_[fl] &= ~(static_cast<size_t>(1) << sl);
+            if (sl_bitmap_[fl] == 0)
+            {
+                fl_bitmap_ &= ~(static_cast<size_t>(1) << fl);
+            }
+        }
+    }
+
+    Block* findSuitable(size_t fl, size_t sl)
+    {
+        size_t sl_map = sl_bitmap_[fl] & (~static_cast<size_t>(0) << sl);
+        if (sl_map == 0)
+        {
+            if (fl + 1 >= FL_INDEX_COUNT)
+            {
+                return nullptr;
+            }
+            size_t fl_map = fl_bitmap_ & (~static_cast<size_t>(0) << (fl + 1));
+            if (fl_map == 0)
+            {
+                return nullptr;
+            }
+            fl = aux::countTrailingZeros(fl_map);
+            sl_map = sl_bitmap_[fl];
+        }
+        return blocks_[fl][aux::countTrailingZeros(sl_map)];
+    }
+
+public:
+
+    void* allocate(size_t n_bytes, size_t alignment = 1)
+    {
+        if (n_bytes == 0 || alignment > ALIGN)
+        {
+            return nullptr;
+        }
+        size_t size = alignUp(n_bytes);
+        if (size < n_bytes)
+        {
+            return nullptr;
+        }
+        size = size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size;
+
+        size_t fl, sl;
+        if (!mappingSearch(size, fl, sl))
+        {
+            return nullptr;
+        }
+        Block* block = findSuitable(fl, sl);
+        if (block == nullptr)
+        {
+            return nullptr;
+        }
+        removeFree(block);
+        free_bytes_ -= blockSize(block);
+        setFree(block, false);
+        setPrevFree(nextPhys(block), false);
+        trimUsed(block, size);
+        return payload(block);
+    }
+
+
+    bool deallocate(void* ptr, size_t = 0)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+        Block* block = fromPayload(ptr);
+        free_bytes_ += blockSize(block);
+        setFree(block, true);
+
+        if (isPrevFree(block))
+        {
+            Block* prev = block->prev_phys;
+            removeFree(prev);
+            setSize(prev, blockSize(prev) + HEADER_SIZE + blockSize(block));
+            free_bytes_ += HEADER_SIZE;
+            block = prev;
+        }
+        Block* next = nextPhys(block);
+        if (isFree(next))
+        {
+            removeFree(next);
+            setSize(block, blockSize(block) + HEADER_SIZE + blockSize(next));
+            free_bytes_ += HEADER_SIZE;
+        }
+        next = nextPhys(block);
+        next->prev_phys = block;
+        setPrevFree(next, true);
+        insertFree(block);
+        return true;
+    }
+
+
+    //grows a used block into a free physical successor
+    bool tryExpand(void* ptr, size_t, size_t new_bytes)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+        Block* block = fromPayload(ptr);
+        size_t size = alignUp(new_bytes);
+        if (size <= blockSize(block))
+        {
+            return true;
+        }
+        Block* next = nextPhys(block);
+        if (!isFree(next) || blockSize(block) + HEADER_SIZE + blockSize(next) < size)
+        {
+            return false;
+        }
+        removeFree(next);
+        free_bytes_ -= blockSize(next);
+        setSize(block, blockSize(block) + HEADER_SIZE + blockSize(next));
+        setPrevFree(nextPhys(block), false);
+        trimUsed(block, size);
+        return true;
+    }
+
+
+    size_t freeBytes() const {return free_bytes_;};
+    size_t totalBytes() const {return total_bytes_;};
+    size_t maxBytes() const {return largestFreeBlock();};
+
+    size_t largestFreeBlock() const
+    {
+        if (fl_bitmap_ == 0)
+        {
+            return 0;
+        }
+        size_t fl = aux::findLastSet(fl_bitmap_);
+        size_t sl = aux::findLastSet(sl_bitmap_[fl]);
+        size_t largest = 0;
+        for (const Block* block = blocks_[fl][sl]; block != nullptr; block = block->next_free)
+        {
+            largest = blockSize(block) > largest ? blockSize(block) : largest;
+        }
+        return largest;
+    }
+
+    //0 when all free memory is one block, approaching 1 as it splinters
+    float fragmentation() const
+    {
+        if (free_bytes_ == 0)
+        {
+            return 0;
+        }
+        return 1.0f - static_cast<float>(largestFreeBlock()) / free_bytes_;
+    }
+
+
+    TlsfResource(void* region, size_t n_bytes)
+        :fl_bitmap_(0), free_bytes_(0), total_bytes_(0)
+    {
+        for (size_t i = 0; i < FL_INDEX_COUNT; i++)
+        {
+            sl_bitmap_[i] = 0;
+            for (size_t j = 0; j < SL_INDEX_COUNT; j++)
+            {
+                blocks_[i][j] = nullptr;
+            }
+        }
+
+        uint8_t* begin = static_cast<uint8_t*>(region);
+        uint8_t* aligned = reinterpret_cast<uint8_t*>(alignUp(reinterpret_cast<uintptr_t>(begin)));
+        if (n_bytes < static_cast<size_t>(aligned - begin) + 3 * HEADER_SIZE + MIN_BLOCK_SIZE)
+        {
+            return;
+        }
+        size_t size = (n_bytes - (aligned - begin) - 2 * HEADER_SIZE) & ~(ALIGN - 1);
+        size_t max_size = (static_cast<size_t>(1) << (aux::TLSF_FL_INDEX_MAX - 1)) - 1;
+        size = size > max_size ? (max_size & ~(ALIGN - 1)) : size;
+
+        Block* block = reinterpret_cast<Block*>(aligned);
+        block->prev_phys = nullptr;
+        block->size = size;
+        setFree(block, true);
+
+        Block* sentinel = nextPhys(block);
+        sentinel->prev_phys = block;
+        sentinel->size = 0;
+        setPrevFree(sentinel, true);
+
+        insertFree(block);
+        free_bytes_ = size;
+        total_bytes_ = size;
+    }
+
+    TlsfResource(const TlsfResource&) = delete;
+    TlsfResource& operator=(const TlsfResource&) = delete;
+
+private:
+    void trimUsed(Block* block, size_t size)
+    {
+        if (blockSize(block) < size + HEADER_SIZE + MIN_BLOCK_SIZE)
+        {
+            return;
+        }
+        Block* remainder = reinterpret_cast<Block*>(static_cast<uint8_t*>(payload(block)) + size);
+        remainder->size = blockSize(block) - size - HEADER_SIZE;
+        setSize(block, size);
+        setFree(remainder, true);
+        setPrevFree(remainder, false);
+
+        Block* next = nextPhys(remainder);
+        if (isFree(next))
+        {
+            removeFree(next);
+            setSize(remainder, blockSize(remainder) + HEADER_SIZE + blockSize(next));
+            free_bytes_ += HEADER_SIZE;
+            next = nextPhys(remainder);
+        }
+        next->prev_phys = remainder;
+        setPrevFree(next, true);
+        insertFree(remainder);
+        free_bytes_ += blockSize(remainder);
+    }
+};
+
+
+template<class T, TlsfResource* resource>
+class TlsfAllocator
+{
+public:
+    static const bool is_movable = true;
+    size_t maxSize() const {return resource->largestFreeBlock()/sizeof(T);};
+
+    T* allocate(size_t n)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    bool deallocate(T* ptr, size_t n)
+    {
+        if (ptr == nullptr)
+        {
+            return true;
+        }
+        return resource->deallocate(ptr, n * sizeof(T));
+    }
+
+    bool tryExpand(T* ptr, size_t old_n, size_t new_n)
+    {
+        return resource->tryExpand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    TlsfAllocator() {};
+};
+
+
+template<class T, TlsfResource* resource>
+class TlsfArena
+{
+public:
+    static const bool is_movable = true;
+    static const bool is_monotonic = false;
+
+    TlsfArena() {};
+
+    template <class ...Args>
+    T* create(Args&&... args)
+    {
+        void* ptr = resource->allocate(sizeof(T), alignof(T));
+        if (ptr == nullptr)
+        {
+            return nullptr;
+        }
+        return new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    bool destroy(T* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+        ptr->~T();
+        return resource->deallocate(ptr, sizeof(T));
+    }
+};
+
+}
+
+#endif
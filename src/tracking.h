@@ -0,0 +1,258 @@
+#ifndef ASTL_TRACKING_H
+#define ASTL_TRACKING_H
+
+#include "allocator.h"
+#include "arena.h"
+#include "bit_operations.h"
+
+namespace astl
+{
+
+//a tag is any type with a static name(), every container using the same tag shares one set of counters
+#define ASTL_ALLOCATION_TAG(TagName, tag_string) \
+    struct TagName {static const char* name() {return tag_string;};}
+
+
+struct AllocationStats
+{
+#if defined(ARDUINO)
+    static const size_t HISTOGRAM_BINS = 16;
+#else
+    static const size_t HISTOGRAM_BINS = 32;
+#endif
+
+    const char* name;
+    size_t allocations;
+    size_t deallocations;
+    size_t refusals;//allocate returned nullptr, e.g. the request was above maxSize()
+    size_t live_bytes;
+    size_t high_water_bytes;
+    size_t largest_request;//in bytes, including refused ones
+    size_t histogram[HISTOGRAM_BINS];//bin i counts requests of [2^i, 2^(i+1)) bytes, the last bin takes the rest
+    AllocationStats* next;
+
+    void recordAllocation(size_t n_bytes)
+    {
+        allocations++;
+        live_bytes += n_bytes;
+        if (live_bytes > high_water_bytes)
+        {
+            high_water_bytes = live_bytes;
+        }
+        recordRequest(n_bytes);
+    }
+
+    void recordRefusal(size_t n_bytes)
+    {
+        refusals++;
+        recordRequest(n_bytes);
+    }
+
+    void recordDeallocation(size_t n_bytes)
+    {
+        deallocations++;
+        live_bytes -= n_bytes < live_bytes ? n_bytes : live_bytes;
+    }
+
+    void recordResize(size_t old_bytes, size_t new_bytes)
+    {
+        recordDeallocation(old_bytes);
+        deallocations--;
+        recordAllocation(new_bytes);
+        allocations--;
+    }
+
+    void reset()
+    {
+        allocations = 0;
+        deallocations = 0;
+        refusals = 0;
+        high_water_bytes = live_bytes;
+        largest_request = 0;
+        for (size_t i = 0; i < HISTOGRAM_BINS; i++)
+        {
+            histogram[i] = 0;
+        }
+    }
+
+    AllocationStats(const char* tag_name);
+
+private:
+    void recordRequest(size_t n_bytes)
+    {
+        if (n_bytes > largest_request)
+        {
+            largest_request = n_bytes;
+        }
+        size_t bin = n_bytes == 0 ? 0 : aux::findLastSet(n_bytes);
+        histogram[bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1]++;
+    }
+};
+
+
+//intrusive list of every tag that has been used at least once
+class AllocationRegistry
+{
+    static AllocationStats*& head()
+    {
+        static AllocationStats* first = nullptr;
+        return first;
+    }
+
+public:
+    static void add(AllocationStats* stats)
+    {
+        stats->next = head();
+        head() = stats;
+    }
+
+    static AllocationStats* first() {return head();};
+
+    template<class Function>
+    static void forEach(Function f)
+    {
+        for (AllocationStats* stats = head(); stats != nullptr; stats = stats->next)
+        {
+            f(*stats);
+        }
+    }
+
+    static void resetAll()
+    {
+        for (AllocationStats* stats = head(); stats != nullptr; stats = stats->next)
+        {
+            stats->reset();
+        }
+    }
+};
+
+
+inline AllocationStats::AllocationStats(const char* tag_name)
+    :name(tag_name), allocations(0), deallocations(0), refusals(0), live_bytes(0), high_water_bytes(0), largest_request(0), next(nullptr)
+{
+    for (size_t i = 0; i < HISTOGRAM_BINS; i++)
+    {
+        histogram[i] = 0;
+    }
+    AllocationRegistry::add(this);
+}
+
+
+template<class Tag>
+inline AllocationStats& allocationStats()
+{
+    static AllocationStats stats(Tag::name());
+    return stats;
+}
+
+
+#if defined(ASTL_TRACK_ALLOCATIONS)
+
+//wraps any allocator and reports into the counters of Tag, the wrapped allocator does the actual work
+template<class Allocator, class Tag>
+class TrackingAllocator
+{
+    Allocator allocator_;
+
+public:
+    static const bool is_movable = Allocator::is_movable;
+    size_t maxSize() const {return allocator_.maxSize();};
+
+    auto allocate(size_t n) -> decltype(allocator_.allocate(n))
+    {
+        auto ptr = allocator_.allocate(n);
+        if (n != 0)
+        {
+            if (ptr == nullptr)
+            {
+                allocationStats<Tag>().recordRefusal(n * sizeof(*ptr));
+            }
+            else
+            {
+                allocationStats<Tag>().recordAllocation(n * sizeof(*ptr));
+            }
+        }
+        return ptr;
+    }
+
+    template<class T>
+    bool deallocate(T* ptr, size_t n)
+    {
+        if (ptr != nullptr)
+        {
+            allocationStats<Tag>().recordDeallocation(n * sizeof(T));
+        }
+        return allocator_.deallocate(ptr, n);
+    }
+
+    template<class T>
+    bool tryExpand(T* ptr, size_t old_n, size_t new_n)
+    {
+        if (!aux::tryExpand(allocator_, ptr, old_n, new_n, 0))
+        {
+            return false;
+        }
+        allocationStats<Tag>().recordResize(old_n * sizeof(T), new_n * sizeof(T));
+        return true;
+    }
+
+    TrackingAllocator() {};
+};
+
+
+template<class Arena, class Tag>
+class TrackingArena
+{
+    Arena arena_;
+
+public:
+    static const bool is_movable = Arena::is_movable;
+    static const bool is_monotonic = aux::isMonotonic<Arena>(0);
+
+    template <class ...Args>
+    auto create(Args&&... args) -> decltype(arena_.create(std::forward<Args>(args)...))
+    {
+        auto ptr = arena_.create(std::forward<Args>(args)...);
+        if (ptr == nullptr)
+        {
+            allocationStats<Tag>().recordRefusal(sizeof(*ptr));
+        }
+        else
+        {
+            allocationStats<Tag>().recordAllocation(sizeof(*ptr));
+        }
+        return ptr;
+    }
+
+    //only pointers the wrapped arena accepts are counted
+    template<class T>
+    bool destroy(T* ptr)
+    {
+        if (!arena_.destroy(ptr))
+        {
+            return false;
+        }
+        if (ptr != nullptr)
+        {
+            allocationStats<Tag>().recordDeallocation(sizeof(T));
+        }
+        return true;
+    }
+
+    TrackingArena() {};
+};
+
+#else
+
+//tracking compiled out, the wrapped type is used as is
+template<class Allocator, class Tag>
+using TrackingAllocator = Allocator;
+
+template<class Arena, class Tag>
+using TrackingArena = Arena;
+
+#endif
+
+}
+
+#endif
@@ -119,6 +119,7 @@ public:
             if (data_.size() > max_load_factor_*numBins())
             {
                 rehash(numBins()*2);
+                it = find(key);
             }
         }
         
@@ -131,14 +132,14 @@ public:
 		if (it != data_.end())
 		{
 			size_t bin = getBin(*it);
-			auto old_it = it;
+			bool is_first = (bins_[bin].it == it);
 			it = data_.erase(it);
             bins_[bin].count--;
             if (bins_[bin].count == 0)
             {
                 bins_[bin].it = end();
             }
-            else
+            else if (is_first)
             {
                 bins_[bin].it = it;
             }
@@ -147,6 +148,50 @@ public:
 		return it;
 	}
     
+    //walks each bin once, fixing up its first iterator and count as elements are dropped
+    template<class Predicate>
+    size_t eraseIf(Predicate pred)
+    {
+        size_t n_erased = 0;
+        for (size_t bin = 0; bin < bins_.size(); bin++)
+        {
+            auto it = bins_[bin].it;
+            const size_t count = bins_[bin].count;
+            bool is_first = true;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (pred(*it))
+                {
+                    it = data_.erase(it);
+                    bins_[bin].count--;
+                    n_erased++;
+                    if (is_first)
+                    {
+                        bins_[bin].it = it;
+                    }
+                }
+                else
+                {
+                    is_first = false;
+                    it++;
+                }
+            }
+            if (bins_[bin].count == 0)
+            {
+                bins_[bin].it = data_.end();
+            }
+        }
+        return n_erased;
+    }
+
+
+    template<class Predicate>
+    size_t retain(Predicate pred)
+    {
+        return eraseIf(aux::NegatedPredicate<Predicate>(pred));
+    }
+
+    
     iterator remove(const Key& key)
     {
         auto it = find(key);
@@ -2,6 +2,8 @@
 #define ASTL_VECTOR_H
 #include "allocator.h"
 #include "initializer_list.h"
+#include "span.h"
+#include "functional.h"
 
 namespace astl
 {
@@ -17,6 +19,11 @@ class Vector
 	{
 		T* new_data;
 		if (new_capacity <= capacity_)
+		{
+			new_data = data_;
+			new_capacity = capacity_;
+		}
+		else if (expandInPlace(allocator_, data_, capacity_, new_capacity))
 		{
 			new_data = data_;
 		}
@@ -34,8 +41,10 @@ class Vector
 			memmove(new_data + new_pos, data_ + old_pos, size_ - old_pos);
 		}
 
-		
-		allocator_.deallocate(data_, capacity_);
+		if (new_data != data_)
+		{
+			allocator_.deallocate(data_, capacity_);
+		}
 		capacity_ = new_capacity;
         data_ = new_data;
 		return true;
@@ -52,6 +61,12 @@ public:
 			return true;
 		}
 
+		if (expandInPlace(allocator_, data_, capacity_, new_capacity))
+		{
+			capacity_ = new_capacity;
+			return true;
+		}
+
 		T* new_data = allocator_.allocate(new_capacity);
 		if (new_data == nullptr)
 		{
@@ -91,6 +106,46 @@ public:
 		return true;
 	}
 
+
+	template<class X = T>
+	bool resizeDefaultInit(size_t new_size)
+	{
+		static_assert(std::is_trivially_constructible<X>::value && std::is_trivially_destructible<X>::value, "resizeDefaultInit requires a trivial type");
+		if (!reserve(new_size))
+		{
+			return false;
+		}
+		size_ = new_size;
+		return true;
+	}
+
+
+	//returns n writable slots past the end, the first k of them become part of the vector on commit(k)
+	Span<T> appendUninitialized(size_t n)
+	{
+		static_assert(std::is_trivially_constructible<T>::value && std::is_trivially_destructible<T>::value, "appendUninitialized requires a trivial type");
+		if (size_ + n > capacity_)
+		{
+			size_t new_capacity = allocPolicy(size_ + n);
+			if (!reserve(new_capacity < size_ + n ? size_ + n : new_capacity))
+			{
+				return Span<T>();
+			}
+		}
+		return Span<T>(data_ + size_, n);
+	}
+
+
+	bool commit(size_t k)
+	{
+		if (k > capacity_ - size_)
+		{
+			return false;
+		}
+		size_ += k;
+		return true;
+	}
+
    
     void copyToBuffer(void* buffer) const
     {
@@ -235,6 +290,36 @@ public:
     }
 
 
+	//removes every element matching pred in a single compaction pass, returns the number of removed elements
+	template<class Predicate>
+	size_t eraseIf(Predicate pred)
+	{
+		size_t n_kept = 0;
+		for (size_t i = 0; i < size_; i++)
+		{
+			if (!pred(data_[i]))
+			{
+				if (n_kept != i)
+				{
+					data_[n_kept] = std::move(data_[i]);
+				}
+				n_kept++;
+			}
+		}
+		size_t n_erased = size_ - n_kept;
+		memclear(data_ + n_kept, n_erased);
+		size_ = n_kept;
+		return n_erased;
+	}
+
+
+	template<class Predicate>
+	size_t retain(Predicate pred)
+	{
+		return eraseIf(aux::NegatedPredicate<Predicate>(pred));
+	}
+
+
     bool popBack() 
     {
 		if (size_ == 0)
@@ -340,6 +425,7 @@ public:
     {
          if(x.allocator_.is_movable)
         {
+            allocator_ = x.allocator_;
             data_ = x.data_;
             size_ = x.size_;
             capacity_ = x.capacity_;
@@ -354,7 +440,6 @@ public:
             x.clear();
             x.shrinkToFit();
         }
-        copyFromBuffer(x.data(), x.size());
     }
 
     template<class X, class Allocator2, AllocationPolicyFunc allocPolicy2>
@@ -389,7 +474,9 @@ public:
         {
             if(x.allocator_.is_movable)
             {
+                clear();
 			    allocator_.deallocate(data_, capacity_);
+                allocator_ = x.allocator_;
                 data_ = x.data_;
                 size_ = x.size_;
                 capacity_ = x.capacity_;
@@ -434,6 +521,13 @@ public:
     }
 
 
+    ~Vector()
+    {
+        clear();
+        allocator_.deallocate(data_, capacity_);
+    }
+
+
 	template<class X, class Allocator2, AllocationPolicyFunc allocPolicy2>
     bool operator==(const Vector<X, Allocator2, allocPolicy2>& x)
     {